@@ -0,0 +1,30 @@
+#ifndef COMMON_FILE_H
+#define COMMON_FILE_H
+
+#include <stdint.h>
+
+// Descriptors every task starts with, all on the console
+#define STDIN_FILENO 0
+#define STDOUT_FILENO 1
+#define STDERR_FILENO 2
+
+// Flags of SYS_OPEN
+#define O_RDONLY 0x0
+#define O_WRONLY 0x1
+#define O_RDWR 0x2
+#define O_ACCMODE 0x3
+#define O_CREAT 0x40
+#define O_TRUNC 0x200
+#define O_APPEND 0x400
+#define O_NONBLOCK 0x800 // Pipes: fail with -2 instead of sleeping
+
+// Filled by SYS_STAT
+typedef struct stat
+{
+    uint32_t size;
+    uint32_t attr; // FAT attribute bits, 0x10 for a directory
+    uint16_t modify_date;
+    uint16_t modify_time;
+} stat_t;
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef COMMON_IPC_H
+#define COMMON_IPC_H
+
+#include <stdint.h>
+
+#define IPC_INLINE_MAX 64 // Bytes copied with a message
+#define IPC_MAX_PAGES 16  // Pages moved with a message
+
+// Flags of SYS_PORT_SEND and SYS_PORT_RECV
+#define IPC_ASYNC 0x1    // Send: queue the message and return without waiting for the receiver
+#define IPC_NONBLOCK 0x1 // Receive: return -2 instead of waiting when the port is empty
+
+/*
+ * Message exchanged through a port. On send, pages/num_pages name a page
+ * aligned payload that is moved to the receiver. On receive they name the
+ * window the payload is mapped into, and are updated to the payload received.
+ */
+typedef struct ipc_msg
+{
+    uint32_t tag;    // Meaning is up to the tasks
+    uint32_t len;    // Bytes used in data
+    uint8_t data[IPC_INLINE_MAX];
+    void *pages;
+    uint32_t num_pages;
+    uint32_t sender; // PID of the sending thread, filled in on receive
+} ipc_msg_t;
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef COMMON_KDATA_H
+#define COMMON_KDATA_H
+
+#include <stdint.h>
+
+#define KDATA_BASE 0x2FFFD000       // Kernel data page, mapped read-only in every task
+#define KDATA_TIMER_BASE 0x2FFFE000 // Timer registers, mapped read-only in every task
+#define KDATA_TIMER_VALUE 0x204     // Offset of the 1MHz clocksource counter (timer 2), which counts down
+
+/*
+ * Page the kernel keeps up to date for user space to read without a trap.
+ * Every update makes seq odd, changes the page, then makes seq even again:
+ * a reader retries if seq was odd or changed while it read.
+ *
+ * The time in microseconds is clock_base_us + (uint32_t)(clock_last - counter),
+ * with counter read from the clocksource at KDATA_TIMER_BASE + KDATA_TIMER_VALUE.
+ */
+typedef struct kdata
+{
+    uint32_t seq;
+    uint32_t clock_last;    // Clocksource counter at clock_base_us
+    uint64_t clock_base_us; // Microseconds since boot at the last update
+    uint64_t ticks;         // Scheduler ticks since boot
+    uint32_t switches;      // Context switches since boot
+    uint32_t pid;           // Running thread
+    uint32_t tgid;          // Leader of the running thread, the PID of its task
+    uint32_t nr_tasks;      // User tasks alive
+} kdata_t;
+
+#endif
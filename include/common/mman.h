@@ -0,0 +1,8 @@
+#ifndef COMMON_MMAN_H
+#define COMMON_MMAN_H
+
+// Protections of SYS_MMAP
+#define PROT_READ 0x1
+#define PROT_WRITE 0x2
+
+#endif
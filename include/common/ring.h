@@ -0,0 +1,54 @@
+#ifndef COMMON_RING_H
+#define COMMON_RING_H
+
+#include <stdint.h>
+
+#define RING_SQ_ENTRIES 32 // Powers of two
+#define RING_CQ_ENTRIES 64
+
+// Operations of a submission entry
+#define RING_OP_NOP 0
+#define RING_OP_READ 1    // read(fd, addr, len), at off unless off is -1
+#define RING_OP_WRITE 2   // write(fd, addr, len), at off unless off is -1
+#define RING_OP_TIMEOUT 3 // Completes once len microseconds have passed
+
+// Flags of SYS_ENTER
+#define RING_ENTER_WAIT 0x1 // Sleep until a completion is available if none is
+
+typedef struct ring_sqe
+{
+    uint32_t op;
+    int32_t fd;
+    uint32_t addr;
+    uint32_t len;
+    int32_t off;
+    uint32_t user_data; // Copied to the completion
+} ring_sqe_t;
+
+typedef struct ring_cqe
+{
+    uint32_t user_data;
+    int32_t res; // Result of the operation, as the matching syscall would return it
+} ring_cqe_t;
+
+/*
+ * Page shared by a task and the kernel. User space fills submission entries
+ * and advances sq_tail; the kernel consumes them, advancing sq_head, and
+ * posts completions at cq_tail. User space consumes completions by advancing
+ * cq_head. Indices run freely and are reduced modulo the ring sizes. If
+ * sq_tail runs more than RING_SQ_ENTRIES ahead of sq_head, the kernel drops
+ * the submissions, sets sq_head to sq_tail and posts a completion with
+ * user_data 0 and res -1.
+ */
+typedef struct ring
+{
+    volatile uint32_t sq_head;
+    volatile uint32_t sq_tail;
+    volatile uint32_t cq_head;
+    volatile uint32_t cq_tail;
+    volatile uint32_t cq_overflow; // Completions dropped because the ring was full
+    ring_sqe_t sqes[RING_SQ_ENTRIES];
+    ring_cqe_t cqes[RING_CQ_ENTRIES];
+} ring_t;
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SCHED_INFO_H
+#define SCHED_INFO_H
+
+#include <stdint.h>
+
+#define SCHED_LAT_BUCKETS 24 // Bucket i counts latencies in [2^i, 2^(i+1)) us, the last one everything above
+
+// Selectors of SYS_SCHED_INFO
+#define SCHED_INFO_TASK 0    // Fill a sched_task_info_t for the task at an index
+#define SCHED_INFO_LATENCY 1 // Fill a sched_latency_info_t
+
+// Scheduling statistics of one task
+typedef struct sched_task_info
+{
+    uint32_t pid;
+    char name[12];
+    uint32_t state;       // RUNNING, READY, BLOCKED or TERMINATED
+    uint32_t switches;    // Number of times the task was switched in
+    uint64_t runtime_us;  // Time spent running
+    uint64_t wait_us;     // Time spent ready but not running
+    uint32_t max_wait_us; // Longest wait between becoming ready and running
+    uint32_t kernel;      // Non-zero for kernel threads
+    uint32_t rt_period_us;   // Real-time parameters, all 0 for best-effort tasks
+    uint32_t rt_runtime_us;
+    uint32_t rt_deadline_us;
+    uint32_t rt_misses;      // Jobs that missed their deadline
+    uint32_t rt_overruns;    // Jobs throttled for exceeding their budget
+    uint32_t syscalls;       // Syscalls made since boot or the last reset of the counters
+    uint32_t syscall_max_us; // Longest of them
+    uint64_t syscall_us;     // Time spent in the kernel on them
+} sched_task_info_t;
+
+// Global histogram of wakeup-to-run latency
+typedef struct sched_latency_info
+{
+    uint64_t uptime_us;
+    uint32_t samples;
+    uint32_t buckets[SCHED_LAT_BUCKETS];
+} sched_latency_info_t;
+
+#endif
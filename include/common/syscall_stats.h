@@ -0,0 +1,26 @@
+#ifndef SYSCALL_STATS_H
+#define SYSCALL_STATS_H
+
+#include <stdint.h>
+
+#define SYSCALL_STATS_MAX 32 // Syscall numbers covered, from 0
+
+// Selectors of SYS_SYSCALL_STATS
+#define SYSCALL_STATS_GET 0   // Fill a syscall_stats_t
+#define SYSCALL_STATS_RESET 1 // Zero every counter, the per-task ones included
+
+// Counters of one syscall, or of every syscall of one task
+typedef struct syscall_stat
+{
+    uint32_t calls;
+    uint32_t max_us;   // Longest call
+    uint64_t total_us; // Time spent in the kernel on these calls
+} syscall_stat_t;
+
+typedef struct syscall_stats
+{
+    uint64_t since_us;                        // Boot or last reset
+    syscall_stat_t calls[SYSCALL_STATS_MAX]; // Indexed by syscall number
+} syscall_stats_t;
+
+#endif
@@ -14,6 +14,7 @@
 #define RESERVE_U8(n) uint8_t CONCAT2(_pad_, __LINE__)[n]
 
 // Linker symbols
+extern uint32_t _text_start;
 extern uint32_t _kernel_heap_start;
 extern uint32_t _kernel_heap_end;
 extern uint32_t _kernel_stack_bottom;
@@ -22,14 +23,10 @@ extern uint32_t _irq_stack_bottom;
 extern uint32_t _irq_stack_top;
 extern uint32_t _svc_stack_bottom;
 extern uint32_t _svc_stack_top;
+extern uint32_t _abt_stack_bottom;
+extern uint32_t _abt_stack_top;
 extern uint32_t _l1pagetable_start;
 extern uint32_t _l1pagetable_end;
-extern uint32_t _coarsepagetables_space_start;
-extern uint32_t _coarsepagetables_space_end;
-extern uint32_t _l1pagetables_space_start;
-extern uint32_t _l1pagetables_space_end;
-extern uint32_t _free_pages_start;
-extern uint32_t _free_pages_end;
 extern uint32_t _kernel_end;
 
 #endif
\ No newline at end of file
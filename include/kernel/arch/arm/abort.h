@@ -0,0 +1,69 @@
+#ifndef ABORT_HANDLER_H
+#define ABORT_HANDLER_H
+
+#include <stdint.h>
+#include <kernel/arch/arm/svc.h>
+#include <kernel/core/task/task.h>
+
+// CPSR mode bits
+#define CPSR_MODE_MASK 0x1F
+#define CPSR_MODE_USR 0x10
+#define CPSR_MODE_FIQ 0x11
+#define CPSR_MODE_IRQ 0x12
+#define CPSR_MODE_SVC 0x13
+#define CPSR_MODE_ABT 0x17
+#define CPSR_MODE_UND 0x1B
+#define CPSR_MODE_SYS 0x1F
+
+// Fault Status Register fields (ARMv5 / ARM926EJ-S)
+#define FSR_STATUS(fsr) ((fsr) & 0xF)
+#define FSR_DOMAIN(fsr) (((fsr) >> 4) & 0xF)
+
+#define FSR_ALIGNMENT 0x1
+#define FSR_ALIGNMENT_ALT 0x3
+#define FSR_EXT_LINEFETCH_SECTION 0x4
+#define FSR_TRANSLATION_SECTION 0x5
+#define FSR_EXT_LINEFETCH_PAGE 0x6
+#define FSR_TRANSLATION_PAGE 0x7
+#define FSR_EXT_SECTION 0x8
+#define FSR_DOMAIN_SECTION 0x9
+#define FSR_EXT_PAGE 0xA
+#define FSR_DOMAIN_PAGE 0xB
+#define FSR_EXT_L1_WALK 0xC
+#define FSR_PERMISSION_SECTION 0xD
+#define FSR_EXT_L2_WALK 0xE
+#define FSR_PERMISSION_PAGE 0xF
+
+#define FSR_IS_TRANSLATION(status) ((status) == FSR_TRANSLATION_SECTION || (status) == FSR_TRANSLATION_PAGE)
+#define FSR_IS_PERMISSION(status) ((status) == FSR_PERMISSION_SECTION || (status) == FSR_PERMISSION_PAGE)
+
+/**
+ * @brief C entry point for data aborts.
+ *
+ * Called from the data abort vector with the faulting register frame, the
+ * fault address (FAR) and the fault status (FSR). Translation faults that fall
+ * inside a demand-paged region of the current task are resolved by mapping a
+ * page and returning, which retries the aborted instruction. Permission faults
+ * on copy-on-write pages are resolved the same way. Any other fault
+ * terminates the current task, or halts the kernel if there is no task to
+ * blame or the fault was taken while handling an interrupt.
+ *
+ * @param regs Register frame saved by the vector stub.
+ * @param far  Fault Address Register.
+ * @param fsr  Data Fault Status Register.
+ */
+void data_abort_handler_c(regs_t *regs, uintptr_t far, uint32_t fsr);
+
+/**
+ * @brief C entry point for prefetch aborts.
+ *
+ * The faulting address is the aborted instruction itself (regs->lr). Fetches
+ * from demand-paged regions are resolved like data aborts; anything else
+ * terminates the current task.
+ *
+ * @param regs Register frame saved by the vector stub.
+ * @param ifsr Instruction Fault Status Register.
+ */
+void prefetch_abort_handler_c(regs_t *regs, uint32_t ifsr);
+
+#endif
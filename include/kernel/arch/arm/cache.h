@@ -0,0 +1,78 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <defs.h>
+
+/*
+ * Cache maintenance by virtual address range for the ARM926EJ-S. Both caches
+ * are virtually indexed and tagged with 32 byte lines, so an address is only
+ * meaningful in the mapping it was written or will be read through: the
+ * kernel's identity mapping of a page and a task's mapping of the same page
+ * are different lines. Every range is widened to whole lines.
+ */
+
+#define DCACHE_LINE_SIZE 32
+#define ICACHE_LINE_SIZE 32
+
+/**
+ * @brief Waits until buffered writes have reached memory.
+ */
+static inline void cache_drain_write_buffer(void)
+{
+    asm volatile("mcr p15, 0, %0, c7, c10, 4" : : "r"(0) : "memory");
+}
+
+/**
+ * @brief Invalidates the whole instruction cache.
+ */
+static inline void icache_invalidate_all(void)
+{
+    asm volatile("mcr p15, 0, %0, c7, c5, 0" : : "r"(0) : "memory");
+}
+
+/**
+ * @brief Writes dirty data cache lines of [start, start + n) back to memory.
+ *
+ * Used after the kernel wrote memory that something else reads: the same page
+ * through another mapping, or the instruction side.
+ */
+void dcache_clean_range(uintptr_t start, size_t n);
+
+/**
+ * @brief Drops the data cache lines of [start, start + n) without writing them back.
+ *
+ * Used before reading memory that was changed behind the cache. Lines only
+ * partly inside the range are cleaned first so bytes next to it are kept.
+ */
+void dcache_invalidate_range(uintptr_t start, size_t n);
+
+/**
+ * @brief Writes back and drops the data cache lines of [start, start + n).
+ *
+ * Used before a page changes hands or is read through another mapping.
+ */
+void dcache_flush_range(uintptr_t start, size_t n);
+
+/**
+ * @brief Writes back and drops the whole data cache.
+ *
+ * Used when the address space changes: lines are tagged by virtual address,
+ * so lines of the previous task would hit at the same addresses in the next.
+ */
+void dcache_flush_all(void);
+
+/**
+ * @brief Drops the instruction cache lines of [start, start + n).
+ */
+void icache_invalidate_range(uintptr_t start, size_t n);
+
+/**
+ * @brief Makes n bytes of code written through kernel address kva visible to
+ *        instruction fetches from va.
+ *
+ * The data cache is cleaned through the mapping the code was written with and
+ * the instruction cache is invalidated for the address it will run at.
+ */
+void cache_sync_code(uintptr_t kva, uintptr_t va, size_t n);
+
+#endif
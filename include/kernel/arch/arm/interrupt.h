@@ -1,7 +1,59 @@
 #ifndef INTERUPT_H
 #define INTERUPT_H
 
-void irq_handler_c(void);
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Registers the bottom halves of the kernel's interrupt sources and enables sources in the PIC.
+ */
+void irq_init(uint32_t sources);
+
+/**
+ * @brief Top half of IRQ handling, called by the IRQ vector in IRQ mode with IRQs masked.
+ *
+ * Acknowledges every pending PIC source and raises the matching softirqs.
+ *
+ * @param frame Registers of the interrupted code, in PCB::context layout.
+ * @return Non-zero if the vector should run softirq_run() before returning.
+ */
+uint32_t irq_enter(uint32_t *frame);
+
+/**
+ * @brief Called by the IRQ vector right before it restores frame.
+ *
+ * When the outermost interrupt returns and the scheduler picked another task,
+ * frame is saved into the interrupted task's context and replaced with the
+ * context of the new one.
+ */
+void irq_exit(uint32_t *frame);
+
+/**
+ * @brief Returns true if the current IRQ may switch tasks: the outermost
+ * interrupt came from task level (user or system mode) or from a task that exited.
+ */
+bool irq_can_switch(void);
+
+/**
+ * @brief Returns true while an IRQ is handled, its bottom halves included.
+ */
+bool irq_in_progress(void);
+
+/**
+ * @brief Enables PIC sources. Use instead of writing IRQ_ENABLESET so that
+ * bottom halves know which sources to restore.
+ */
+void irq_enable_sources(uint32_t mask);
+
+/**
+ * @brief Disables PIC sources.
+ */
+void irq_disable_sources(uint32_t mask);
+
+/**
+ * @brief Returns the PIC sources enabled with irq_enable_sources().
+ */
+uint32_t irq_enabled_sources(void);
 
 #define cli()                           \
     do                                  \
@@ -55,4 +107,36 @@ void irq_handler_c(void);
             : "memory");                \
     } while (0)
 
+/**
+ * @brief Masks IRQs and returns the previous CPSR so the state can be restored.
+ */
+static inline unsigned int irq_save(void)
+{
+    unsigned int flags, tmp;
+    asm volatile(
+        "mrs %0, cpsr\n\t"
+        "orr %1, %0, #(1 << 7)\n\t"
+        "msr cpsr_c, %1\n\t"
+        : "=r"(flags), "=r"(tmp)
+        :
+        : "memory");
+    return flags;
+}
+
+/**
+ * @brief Restores the IRQ mask saved by irq_save().
+ */
+static inline void irq_restore(unsigned int flags)
+{
+    asm volatile("msr cpsr_c, %0\n\t" : : "r"(flags) : "memory");
+}
+
+/**
+ * @brief Puts the core to sleep until the next interrupt (ARM926EJ-S CP15 wait for interrupt).
+ */
+static inline void wait_for_interrupt(void)
+{
+    asm volatile("mcr p15, 0, %0, c7, c0, 4\n\t" : : "r"(0) : "memory");
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <defs.h>
+#include <kernel/hw/cm.h>
+
+/*
+ * Physical memory layout, decided at boot from the size of RAM. The kernel
+ * image sits at the bottom of RAM; the pools of the page allocators follow it,
+ * each on its own sections, and the 4K page pool takes whatever is left.
+ */
+
+#define MEM_DEFAULT_SIZE 0xA00000 // 10 MB, used when the size cannot be detected
+#define MEM_MAX_SIZE 0x8000000    // RAM is identity mapped, so it must end below TASK_TEXT_BASE
+#define MEM_L1_POOL_SIZE 0x200000 // 2 MB of L1 tables
+#define MEM_COARSE_POOL_RATIO 32  // 1 MB of coarse tables per 32 MB of RAM
+#define MEM_ALIGN_SECTION(addr) (((addr) + 0xFFFFF) & ~(uintptr_t)0xFFFFF)
+
+// ATAG list passed by a Linux style boot loader in r2
+#define ATAG_NONE 0x00000000
+#define ATAG_CORE 0x54410001
+#define ATAG_MEM 0x54410002
+#define ATAG_MAX_TAGS 64
+
+typedef struct
+{
+    uint32_t size; // Size of the tag in words, header included
+    uint32_t tag;
+} atag_header_t;
+
+typedef struct
+{
+    uint32_t size;
+    uint32_t start;
+} atag_mem_t;
+
+#define MEM_SOURCE_DEFAULT 0
+#define MEM_SOURCE_ATAG 1
+#define MEM_SOURCE_CM 2
+
+typedef struct
+{
+    size_t ram_size;
+    uint8_t source;       // Where ram_size came from (MEM_SOURCE_*)
+    uintptr_t kernel_end; // End of the kernel sections
+    uintptr_t coarse_start;
+    size_t coarse_size;
+    uintptr_t l1_start;
+    size_t l1_size;
+    uintptr_t pages_start;
+    size_t pages_size;
+} mem_layout_t;
+
+extern mem_layout_t mem_layout;
+
+/**
+ * @brief Detects the size of RAM and lays out the page allocator pools.
+ *
+ * Called from boot.s with the MMU off, before init_page_table(). The size is
+ * taken from the ATAG_MEM tag of the list at atags if there is a valid one,
+ * then from the SDRAM register of the Integrator core module if its ID and
+ * size encoding are valid, and defaults to MEM_DEFAULT_SIZE. It is capped to
+ * MEM_MAX_SIZE.
+ *
+ * @param atags Value of r2 at reset (0 if the kernel was not booted with tags).
+ */
+void mem_init(uintptr_t atags);
+
+/**
+ * @brief Prints the detected RAM size and the pool layout.
+ */
+void mem_print(void);
+
+#endif
@@ -8,10 +8,13 @@
 #include <kernel/hw/timer.h>
 #include <common/memory.h>
 #include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mem.h>
 
 #define NUM_L1_ENTRIES 4096
 #define NUM_COARSE_ENTRIES 256
 #define SMALL_PAGE_SIZE 4096
+#define LARGE_PAGE_SIZE 65536
+#define LARGE_PAGE_ENTRIES 16 // A large page is repeated in 16 consecutive coarse table entries
 #define TINY_PAGE_SIZE 1024
 #define L1_TABLE_SIZE 16384
 
@@ -35,12 +38,10 @@
 #define B_BUF 0
 #define B_NBUF 1
 
-#define COARSE_TABLE_ALLOCATOR_SPACE_SIZE ((uint32_t)&_coarsepagetables_space_end - (uint32_t)&_coarsepagetables_space_start)
-#define PAGE_ALLOCATOR_SPACE_SIZE ((uint32_t)&_free_pages_end - (uint32_t)&_free_pages_start)
-#define L1_TABLE_ALLOCATOR_SPACE_SIZE ((uint32_t)&_l1pagetables_space_end - (uint32_t)&_l1pagetables_space_start)
 #define SECTION_SIZE 0x100000
 #define SECTION_MASK 0xFFF00000
 #define COARSE_MASK 0xFFFFFC00
+#define LARGE_PAGE_MASK 0xFFFF0000
 #define PAGE_MASK 0xFFFFF000
 #define PAGE_OFFSET_MASK 0xFFF
 
@@ -61,11 +62,24 @@
      ((c) << 3) |                 /* bit 3 = C bit */                   \
      ((b) << 2) |                 /* bit 2 = B bit */                   \
      L2_TYPE_SMALL)               /* bits 1:0 = 0b10 for small page */
+#define L2_LARGE_ENTRY(phys_addr, ap, c, b)                              \
+    (((phys_addr) & 0xFFFF0000) | /* bits 31:16 = 64KB page base addr */ \
+     ((ap) << 4) |                /* bits 11:4 = AP bits */              \
+     ((c) << 3) |                 /* bit 3 = C bit */                    \
+     ((b) << 2) |                 /* bit 2 = B bit */                    \
+     L2_TYPE_LARGE)               /* bits 1:0 = 0b01 for large page */
 
 #define L1_INDEX(virt_addr) ((virt_addr) >> 20)                      // Index into the l1 page table for a virtual address
 #define L2_INDEX(virt_addr) (((virt_addr) >> 12) & 0xFF)             // Index into an l2 page table for a virtual address
 #define COARSE_BASE(l1_entry) ((l1_entry) & 0xFFFFFC00)              // Get base address of the coarse page table from the l1 entry
 #define COARSE_PAGE_BASE(coarse_entry) ((coarse_entry) & 0xFFFFF000) // Get base address of the physical page from the coarse table entry
+#define L1_DOMAIN(l1_entry) (((l1_entry) >> 5) & 0xF)                // Get the domain of an l1 entry
+#define L2_AP_MASK (0xFF << 4)                                        // AP bits of a small page entry
+#define L2_GET_AP(l2_entry) (((l2_entry) >> 4) & 0xFF)                // Get the AP bits of a small page entry
+#define L2_SET_AP(l2_entry, ap) (((l2_entry) & ~L2_AP_MASK) | ((ap) << 4)) // Replace the AP bits of a small page entry
+#define SECTION_AP_MASK (3 << 10)                                           // AP bits of a section entry
+#define SECTION_GET_AP(l1_entry) (((l1_entry) >> 10) & 3)                  // Get the AP bits of a section entry
+#define SECTION_SET_AP(l1_entry, ap) (((l1_entry) & ~SECTION_AP_MASK) | ((ap) << 10)) // Replace the AP bits of a section entry
 
 #define DOMAIN_KERNEL 0
 #define DOMAIN_USER 1
@@ -119,9 +133,67 @@ static inline bool is_valid_l1_coarse_entry(uint32_t entry)
     return ((entry & 0x3) == 0x1) && (entry & (1 << 4));
 }
 
+static inline bool is_valid_l2_large_entry(uint32_t entry)
+{
+    return (entry & 0x3) == L2_TYPE_LARGE;
+}
+
+// A small page, or one of the 16 copies of a large page
 static inline bool is_valid_l2_coarse_entry(uint32_t entry)
 {
-    return (entry & 0x3) == L2_TYPE_SMALL;
+    return (entry & 0x3) == L2_TYPE_SMALL || is_valid_l2_large_entry(entry);
+}
+
+// Sections mapped for a task rather than for the kernel or the hardware
+static inline bool is_user_section_entry(uint32_t entry)
+{
+    return is_valid_l1_section_entry(entry) && L1_DOMAIN(entry) == DOMAIN_USER;
+}
+
+// Physical address of the 4KB page mapped at va by a small or large page entry
+static inline uintptr_t l2_page_base(uint32_t entry, uintptr_t va)
+{
+    if (is_valid_l2_large_entry(entry))
+        return (entry & LARGE_PAGE_MASK) | (va & ~LARGE_PAGE_MASK & PAGE_MASK);
+
+    return COARSE_PAGE_BASE(entry);
+}
+
+/**
+ * @brief Returns the mapping of the 4KB page at va as a small page entry, or 0 if there is none.
+ *
+ * Pages inside a large page or a user section are reported as the small page
+ * they contain, with the same permissions, so callers that only look at one
+ * page do not have to care how it is mapped.
+ */
+static inline uint32_t page_entry(uint32_t *l1, uintptr_t va)
+{
+    uint32_t l1_entry = l1[L1_INDEX(va)];
+
+    if (is_user_section_entry(l1_entry))
+    {
+        uintptr_t page = (l1_entry & SECTION_MASK) | (va & ~SECTION_MASK & PAGE_MASK);
+        return L2_PAGE_ENTRY(page, AP(SECTION_GET_AP(l1_entry)), (l1_entry >> 3) & 1, (l1_entry >> 2) & 1);
+    }
+
+    if (!is_valid_l1_coarse_entry(l1_entry))
+        return 0;
+
+    uint32_t entry = ((uint32_t *)COARSE_BASE(l1_entry))[L2_INDEX(va)];
+    if (!is_valid_l2_coarse_entry(entry))
+        return 0;
+
+    return (entry & ~(PAGE_MASK | 0x3)) | l2_page_base(entry, va) | L2_TYPE_SMALL;
+}
+
+static inline void tlb_invalidate_all(void)
+{
+    asm volatile("mcr p15, 0, %0, c8, c7, 0" : : "r"(0) : "memory"); // Invalidate unified TLB
+}
+
+static inline void tlb_invalidate_va(uintptr_t va)
+{
+    asm volatile("mcr p15, 0, %0, c8, c7, 1" : : "r"(va & PAGE_MASK) : "memory"); // Invalidate single entry by MVA
 }
 
 void init_page_table(uint32_t *l1);
@@ -155,6 +227,36 @@ void map_page(uintptr_t coarse_pt_phys, uintptr_t va, uintptr_t page_phys, uint8
 
 void set_l1_entry(uintptr_t va, uint32_t entry);
 
+/**
+ * @brief Returns the coarse page table covering a virtual address, allocating it if needed.
+ *
+ * If the L1 entry for the given virtual address is empty, a zeroed coarse page table is
+ * allocated from the 1K allocator and installed with the given domain.
+ *
+ * @param l1     L1 page table to look up (physical address).
+ * @param va     Virtual address whose coarse page table is wanted.
+ * @param domain Domain to use if a new coarse page table has to be installed.
+ *
+ * @return Physical address of the coarse page table, or NULL if the L1 entry maps a
+ *         section or no coarse page table could be allocated.
+ */
+uint32_t *get_coarse_table(uint32_t *l1, uintptr_t va, uint8_t domain);
+
+/**
+ * @brief Breaks the large page or user section covering va into small pages.
+ *
+ * The small pages map the same physical memory with the same permissions, so
+ * nothing changes for the task. Callers use it before remapping or changing
+ * the permissions of a single 4KB page. Kernel sections are never split.
+ *
+ * @param l1 L1 page table of the task (physical address).
+ * @param va Virtual address of the page about to change.
+ *
+ * @return 0 if va is now mapped by a small page (or not at all), -1 if no coarse
+ *         page table could be allocated for a section.
+ */
+int8_t split_page_mapping(uint32_t *l1, uintptr_t va);
+
 static void *translate_addr(uint32_t *l1, uintptr_t va)
 {
     uint32_t l1_entry = l1[L1_INDEX(va)];
@@ -168,7 +270,7 @@ static void *translate_addr(uint32_t *l1, uintptr_t va)
     {
         uint32_t *coarse_pt = (uint32_t *)(COARSE_BASE(l1_entry));
         uint32_t coarse_entry = coarse_pt[L2_INDEX(va)];
-        return (void *)(COARSE_PAGE_BASE(coarse_entry) + (va & PAGE_OFFSET_MASK));
+        return (void *)(l2_page_base(coarse_entry, va) + (va & PAGE_OFFSET_MASK));
     }
 
     return NULL;
@@ -0,0 +1,51 @@
+#ifndef SOFTIRQ_H
+#define SOFTIRQ_H
+
+#include <defs.h>
+
+/*
+ * Bottom halves, highest priority first. A bottom half can only be preempted
+ * by the bottom half of a higher priority (lower numbered) softirq.
+ */
+#define SOFTIRQ_UART 0  // Console input
+#define SOFTIRQ_SOFT 1  // PIC software interrupt
+#define SOFTIRQ_TIMER 2 // Scheduler tick
+#define NR_SOFTIRQS 3
+
+typedef void (*softirq_fn_t)(void);
+
+/**
+ * @brief Registers the bottom half of a softirq.
+ *
+ * @param nr       Softirq number, which is also its priority.
+ * @param fn       Handler, run in SVC mode with IRQs enabled.
+ * @param pic_mask PIC sources kept disabled while fn runs: the sources of this
+ *                 and every lower priority softirq. Higher priority sources
+ *                 stay enabled and may preempt fn.
+ */
+void softirq_register(uint8_t nr, softirq_fn_t fn, uint32_t pic_mask);
+
+/**
+ * @brief Marks a softirq pending. Called from top halves with IRQs masked.
+ */
+void softirq_raise(uint8_t nr);
+
+/**
+ * @brief Returns true while a bottom half is running.
+ */
+bool softirq_in_progress(void);
+
+/**
+ * @brief Returns true if a pending softirq may preempt the running bottom half.
+ */
+bool softirq_runnable(void);
+
+/**
+ * @brief Runs pending softirqs of higher priority than the bottom half that
+ * was interrupted, or all of them if none was running.
+ *
+ * Called from the IRQ vector in SVC mode with IRQs enabled.
+ */
+void softirq_run(void);
+
+#endif
@@ -2,9 +2,19 @@
 #define SVC_H
 
 #include <stdint.h>
+#include <common/syscall_stats.h>
 #include <kernel/drivers/uart.h>
 #include <kernel/fs/fat/fat32.h>
 #include <kernel/core/task/task.h>
+#include <kernel/core/task/uaccess.h>
+#include <kernel/core/task/files.h>
+#include <kernel/core/task/shm.h>
+#include <kernel/core/task/futex.h>
+#include <kernel/core/task/ipc.h>
+#include <kernel/core/task/ring.h>
+#include <kernel/core/task/mmap.h>
+
+#define NR_SYSCALLS 30 // One more than the highest syscall number
 
 #ifndef SYS_EXIT
 #define SYS_EXIT 1
@@ -18,6 +28,110 @@
 #define SYS_READ 3
 #endif
 
+#ifndef SYS_FORK
+#define SYS_FORK 4
+#endif
+
+#ifndef SYS_SCHED_INFO
+#define SYS_SCHED_INFO 5
+#endif
+
+#ifndef SYS_YIELD
+#define SYS_YIELD 6
+#endif
+
+#ifndef SYS_WAIT
+#define SYS_WAIT 7
+#endif
+
+#ifndef SYS_CLONE
+#define SYS_CLONE 8
+#endif
+
+#ifndef SYS_SCHED_SETRT
+#define SYS_SCHED_SETRT 9
+#endif
+
+#ifndef SYS_OPEN
+#define SYS_OPEN 10
+#endif
+
+#ifndef SYS_WRITE
+#define SYS_WRITE 11
+#endif
+
+#ifndef SYS_LSEEK
+#define SYS_LSEEK 12
+#endif
+
+#ifndef SYS_CLOSE
+#define SYS_CLOSE 13
+#endif
+
+#ifndef SYS_STAT
+#define SYS_STAT 14
+#endif
+
+#ifndef SYS_SHM_ATTACH
+#define SYS_SHM_ATTACH 15
+#endif
+
+#ifndef SYS_SHM_DETACH
+#define SYS_SHM_DETACH 16
+#endif
+
+#ifndef SYS_FUTEX_WAIT
+#define SYS_FUTEX_WAIT 17
+#endif
+
+#ifndef SYS_FUTEX_WAKE
+#define SYS_FUTEX_WAKE 18
+#endif
+
+#ifndef SYS_PORT_CREATE
+#define SYS_PORT_CREATE 19
+#endif
+
+#ifndef SYS_PORT_DESTROY
+#define SYS_PORT_DESTROY 20
+#endif
+
+#ifndef SYS_PORT_SEND
+#define SYS_PORT_SEND 21
+#endif
+
+#ifndef SYS_PORT_RECV
+#define SYS_PORT_RECV 22
+#endif
+
+#ifndef SYS_RING_SETUP
+#define SYS_RING_SETUP 23
+#endif
+
+#ifndef SYS_ENTER
+#define SYS_ENTER 24
+#endif
+
+#ifndef SYS_PIPE
+#define SYS_PIPE 25
+#endif
+
+#ifndef SYS_MMAP
+#define SYS_MMAP 26
+#endif
+
+#ifndef SYS_MUNMAP
+#define SYS_MUNMAP 27
+#endif
+
+#ifndef SYS_MSYNC
+#define SYS_MSYNC 28
+#endif
+
+#ifndef SYS_SYSCALL_STATS
+#define SYS_SYSCALL_STATS 29
+#endif
+
 typedef struct regs
 {
     int32_t r0, r1, r2, r3;
@@ -27,6 +141,31 @@ typedef struct regs
     uint32_t spsr;
 } regs_t;
 
+// A syscall takes its arguments from r0-r3 of the frame and returns the value for r0
+typedef int32_t (*syscall_fn_t)(regs_t *regs);
+
+/**
+ * @brief C entry point for svc, dispatching on the syscall number in r7.
+ *
+ * Unknown numbers return -1 to the caller. Every call is counted for its
+ * syscall and its thread, with the time spent in the handler read from the
+ * clocksource. A blocking call that restarts counts once per attempt.
+ */
 void svc_handler_c(regs_t *regs);
 
+/**
+ * @brief Copies the per-syscall counters.
+ */
+void syscall_stats_get(syscall_stats_t *out);
+
+/**
+ * @brief Zeroes the per-syscall and per-task counters.
+ */
+void syscall_stats_reset(void);
+
+/**
+ * @brief Returns the name of a syscall number, or NULL if there is no such syscall.
+ */
+const char *syscall_name(uint32_t nr);
+
 #endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <kernel/fs/fat/fat32.h>
 #include <kernel/lib/malloc.h>
+#include <kernel/core/task/task.h>
+#include <kernel/arch/arm/svc.h>
 
 int8_t chdir(const char *path);
 void ls(const char *path);
@@ -12,5 +14,7 @@ int8_t mkdir(const char *path);
 int8_t rmdir(const char *path);
 int8_t touch(const char *path);
 int8_t cat(const char *path);
+void top(void);
+void sysstat(bool reset);
 
 #endif
\ No newline at end of file
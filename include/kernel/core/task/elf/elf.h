@@ -9,6 +9,7 @@
 #include <kernel/arch/arm/mmu.h>
 #include <kernel/core/task/elf/elf_defs.h>
 #include <kernel/core/task/elf/elf_utils.h>
+#include <kernel/core/task/elf/image_cache.h>
 #include <kernel/core/task/task.h>
 #include <kernel/fs/fat/fat32.h>
 #include <kernel/arch/arm/mmu.h>
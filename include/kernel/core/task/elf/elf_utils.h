@@ -6,7 +6,9 @@
 #include <kernel/core/task/elf/dynamic.h>
 #include <kernel/fs/fat/fat32.h>
 #include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/vm_region.h>
 #include <kernel/arch/arm/mmu.h>
+#include <kernel/arch/arm/cache.h>
 #include <kernel/lib/printk.h>
 #include <common/math.h>
 
@@ -0,0 +1,77 @@
+#ifndef IMAGE_CACHE_H
+#define IMAGE_CACHE_H
+
+#include <defs.h>
+#include <common/string.h>
+#include <kernel/lib/malloc.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/lib/printk.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/fs/fat/fat32.h>
+#include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/vm_region.h>
+#include <kernel/core/task/elf/so_loader.h>
+
+#define IMAGE_CACHE_MAX 4 // Maximum number of cached executables
+
+/**
+ * @brief Starts a task from the cached image of an executable.
+ *
+ * The image is only used if the directory entry of path still matches the one
+ * it was loaded from. On success the task gets its own descriptor for path,
+ * a copy of the image's regions and the shared objects it was relocated
+ * against, at the same addresses. No page is read or relocated: pages are
+ * shared from the cache as the task touches them.
+ *
+ * @return The entry point, or 0 if path is not cached (the caller loads it).
+ */
+uintptr_t image_cache_attach(const char *path, struct PCB *task);
+
+/**
+ * @brief Caches the executable that was just loaded into task.
+ *
+ * Every page already present in the task (the ones touched by relocation) is
+ * kept by the cache and remapped read-only in the task, so writable pages are
+ * copied on the first write. Pages touched later are added by vm_region_fault().
+ * Nothing happens if the cache is full of images in use.
+ */
+void image_cache_insert(const char *path, struct PCB *task, uintptr_t entry);
+
+/**
+ * @brief Evicts the images loaded from the file starting at first_cluster.
+ *
+ * Called before the file is written or truncated: FAT32 does not update the
+ * modification time, so an overwrite that keeps the first cluster and the
+ * size would otherwise still match the cached image.
+ */
+void image_cache_invalidate(uint32_t first_cluster);
+
+/**
+ * @brief Returns the cached physical page backing va, or 0 if it is not cached.
+ */
+uintptr_t image_cache_page(image_t *image, uintptr_t va);
+
+/**
+ * @brief Stores page as the pristine copy of the page at va.
+ *
+ * The cache takes its own reference on the page. The caller must map it read-only.
+ *
+ * @return 0 if the page was added, -1 if va is outside the image.
+ */
+int8_t image_cache_add_page(image_t *image, uintptr_t va, uintptr_t page);
+
+/**
+ * @brief Takes a reference on an image for a new task (fork).
+ */
+void image_get(image_t *image);
+
+/**
+ * @brief Drops a task's reference on an image.
+ *
+ * Unused images stay cached so the next start of the executable is cheap.
+ * Images that went stale are freed with their last reference.
+ */
+void image_put(image_t *image);
+
+#endif
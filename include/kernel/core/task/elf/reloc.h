@@ -4,6 +4,8 @@
 #include <defs.h>
 #include <kernel/core/task/elf/elf.h>
 #include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/vm_region.h>
+#include <kernel/core/task/uaccess.h>
 #include <kernel/core/task/elf/so_loader.h>
 #include <kernel/lib/printk.h>
 
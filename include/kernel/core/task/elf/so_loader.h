@@ -18,4 +18,27 @@ int8_t load_shared_object(const char *name, struct PCB *task);
 uintptr_t resolve_symbol(const char *sym_name, so_entry_task_t *list);
 void unload_shared_objects(struct PCB *task);
 
+/*
+ *    Appends a copy of every entry of src to the list at dst, taking a reference on each shared object.
+ */
+int8_t copy_shared_object_list(so_entry_task_t **dst, so_entry_task_t *src);
+
+/*
+ *    Drops the references held by a list of shared objects and frees the list.
+ *    Shared objects whose last reference goes away are unloaded.
+ */
+void release_shared_object_list(so_entry_task_t **list);
+
+/*
+ *    Gives dst a reference to every shared object loaded in src, at the same base addresses.
+ *    The pages themselves are shared through dst's copy of src's page tables.
+ */
+int8_t copy_shared_objects(struct PCB *dst, struct PCB *src);
+
+/*
+ *    Maps every shared object of list into task at the base address recorded in the list.
+ *    The shared objects must still be loaded, which holding a reference on them guarantees.
+ */
+int8_t attach_shared_objects(struct PCB *task, so_entry_task_t *list);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef TASK_FILES_H
+#define TASK_FILES_H
+
+#include <defs.h>
+#include <common/file.h>
+#include <common/string.h>
+#include <kernel/fs/fat/fat32.h>
+#include <kernel/drivers/uart.h>
+#include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/uaccess.h>
+#include <kernel/core/task/pipe.h>
+#include <kernel/fs/page_cache.h>
+
+#define FILE_PATH_MAX 128 // Longest path a task may pass, terminator included
+
+struct regs;
+
+/**
+ * @brief Gives a new task its console descriptors and nothing else.
+ */
+void files_init(struct PCB *task);
+
+/**
+ * @brief Duplicates the descriptor table of src into dst (fork).
+ *
+ * Each open file gets its own FAT32 descriptor at the same position.
+ *
+ * @return 0 on success, -1 if the FAT32 file table is full (dst is left empty).
+ */
+int8_t files_copy(struct PCB *dst, struct PCB *src);
+
+/**
+ * @brief Closes every descriptor of a task.
+ */
+void files_close_all(struct PCB *task);
+
+/**
+ * @brief Opens a file for the current task (SYS_OPEN).
+ *
+ * @param path  Path in user memory.
+ * @param flags O_* flags. O_CREAT creates a missing file, O_TRUNC empties it.
+ * @return The new descriptor, or -1 on failure.
+ */
+int32_t file_open(const char *path, uint32_t flags);
+
+/**
+ * @brief Reads from a descriptor of the current task (SYS_READ).
+ *
+ * The data goes straight into the user buffer, which is faulted in and made
+ * private first.
+ *
+ * @return Bytes read, 0 at end of file, -1 on failure,
+ *         PIPE_WOULD_BLOCK if the descriptor is an empty pipe.
+ */
+int32_t file_read(int32_t fd, void *buf, size_t n);
+
+/**
+ * @brief Writes a user buffer to a descriptor of the current task (SYS_WRITE).
+ *
+ * Writes to a console descriptor go to the UART in one call.
+ *
+ * @return Bytes written, -1 on failure, PIPE_WOULD_BLOCK if the descriptor is a full pipe.
+ */
+int32_t file_write(int32_t fd, const void *buf, size_t n);
+
+/**
+ * @brief Moves the position of a descriptor (SYS_LSEEK).
+ *
+ * @param whence SEEK_SET, SEEK_CUR or SEEK_END.
+ * @return The new position, or -1 on failure.
+ */
+int32_t file_lseek(int32_t fd, int32_t offset, uint32_t whence);
+
+/**
+ * @brief Closes a descriptor of the current task (SYS_CLOSE).
+ */
+int32_t file_close(int32_t fd);
+
+/**
+ * @brief Describes the file at a user path (SYS_STAT).
+ *
+ * @return 0 on success, -1 if the path does not exist or out is not writable.
+ */
+int32_t file_stat(const char *path, stat_t *out);
+
+/**
+ * @brief SYS_READ: file_read() that sleeps while a pipe is empty.
+ *
+ * The call restarts once the pipe changes. Descriptors with O_NONBLOCK
+ * return PIPE_WOULD_BLOCK instead.
+ */
+int32_t file_read_wait(struct regs *regs);
+
+/**
+ * @brief SYS_WRITE: file_write() that sleeps while a pipe is full.
+ */
+int32_t file_write_wait(struct regs *regs);
+
+/**
+ * @brief Creates a pipe and installs both ends in the current task (SYS_PIPE).
+ *
+ * @param fds       Receives the read end, then the write end, in user memory.
+ * @param flags     O_NONBLOCK to make both ends non-blocking.
+ * @param num_pages Buffer size in pages, a power of two up to PIPE_MAX_PAGES (0 for 1).
+ * @return 0 on success, -1 on failure.
+ */
+int32_t file_pipe(int32_t *fds, uint32_t flags, uint32_t num_pages);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <defs.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/arch/arm/interrupt.h>
+#include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/uaccess.h>
+
+#define FUTEX_HASH_SIZE 32 // Buckets of waiters, a power of two
+
+/**
+ * @brief Sleeps until futex_wake() on uaddr if *uaddr still equals expected (SYS_FUTEX_WAIT).
+ *
+ * Waiters are keyed by the physical address of the word, so tasks sharing the
+ * page through shared memory wait on the same futex. The page is made private
+ * first, so a copy-on-write page does not change address under a waiter.
+ *
+ * @return 0 once woken (possibly spuriously), -1 if uaddr is not a user word,
+ *         -2 if *uaddr did not hold expected.
+ */
+int32_t futex_wait(uint32_t *uaddr, uint32_t expected);
+
+/**
+ * @brief Wakes up to count tasks waiting on uaddr, oldest first (SYS_FUTEX_WAKE).
+ *
+ * @return Number of tasks woken, or -1 if uaddr is not a user word.
+ */
+int32_t futex_wake(uint32_t *uaddr, uint32_t count);
+
+/**
+ * @brief Removes a task from the futex it waits on. Called by task_wake().
+ */
+void futex_cancel(struct PCB *task);
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <defs.h>
+#include <common/ipc.h>
+#include <common/string.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/uaccess.h>
+
+#define IPC_MAX_PORTS 16
+#define IPC_QUEUE_MAX 8 // Messages a port holds before sends fail
+
+struct regs;
+
+// Message queued on a port
+typedef struct ipc_kmsg
+{
+    uint32_t tag;
+    uint32_t len;
+    uint8_t data[IPC_INLINE_MAX];
+    uintptr_t pages[IPC_MAX_PAGES]; // Physical pages in transit, the message owns their references
+    uint32_t num_pages;
+    uint32_t sender_pid;
+    struct PCB *sender; // Blocked sender of a synchronous message, NULL otherwise
+    struct ipc_kmsg *next;
+} ipc_kmsg_t;
+
+typedef struct ipc_port
+{
+    struct PCB *owner;    // Task allowed to receive, NULL if the port is free
+    struct PCB *receiver; // Thread blocked in a receive
+    ipc_kmsg_t *head;
+    ipc_kmsg_t *tail;
+    uint32_t count;
+} ipc_port_t;
+
+/**
+ * @brief Creates a port the current task receives from (SYS_PORT_CREATE).
+ *
+ * @return The port number, or -1 if every port is in use.
+ */
+int32_t ipc_port_create(void);
+
+/**
+ * @brief Destroys a port of the current task (SYS_PORT_DESTROY).
+ *
+ * Queued messages are dropped and synchronous senders fail with -1.
+ */
+int32_t ipc_port_destroy(int32_t port);
+
+/**
+ * @brief Sends a message to a port (SYS_PORT_SEND).
+ *
+ * The inline data is copied. A page payload is moved: its pages are unmapped
+ * from the sender and later mapped into the receiver, without copying. The
+ * sender's range reads back as fresh memory afterwards. Unless flags has
+ * IPC_ASYNC the sender sleeps until the message is received.
+ *
+ * @return 0 on success, -1 for a bad port or message, -2 if the port is full.
+ */
+int32_t ipc_send(int32_t port, const ipc_msg_t *msg, uint32_t flags);
+
+/**
+ * @brief Receives the oldest message of a port owned by the current task (SYS_PORT_RECV).
+ *
+ * Waits for a message unless flags has IPC_NONBLOCK. A page payload replaces
+ * the pages of the window msg->pages, which must be page aligned, writable
+ * and at least as large as the payload.
+ *
+ * @return 0 on success, -1 for a bad port or window, -2 if the port is empty.
+ */
+int32_t ipc_receive(struct regs *regs);
+
+/**
+ * @brief Forgets a task in every port: a pending synchronous send becomes
+ * asynchronous and the task no longer waits to receive.
+ *
+ * Called by task_wake() when a sender is woken for another reason, and by task_exit().
+ */
+void ipc_cancel(struct PCB *task);
+
+/**
+ * @brief Destroys every port owned by a task that is torn down.
+ */
+void ipc_release_ports(struct PCB *task);
+
+#endif
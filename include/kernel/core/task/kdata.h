@@ -0,0 +1,50 @@
+#ifndef KDATA_H
+#define KDATA_H
+
+#include <defs.h>
+#include <common/kdata.h>
+#include <common/string.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/drivers/timer.h>
+
+struct PCB;
+
+/**
+ * @brief Allocates the kernel data page. Called once by task_init().
+ *
+ * @return 0 on success, -1 if out of memory.
+ */
+int8_t kdata_init(void);
+
+/**
+ * @brief Maps the kernel data page and the clocksource read-only into a task's L1 table.
+ *
+ * Neither page is reference counted: they are shared by every task and never
+ * freed, so free_address_space() and fork() skip them (see kdata_va()).
+ *
+ * @return 0 on success, -1 if no coarse table could be allocated.
+ */
+int8_t kdata_map(uint32_t *pt);
+
+/**
+ * @brief Returns whether va is one of the pages mapped by kdata_map().
+ */
+static inline bool kdata_va(uintptr_t va)
+{
+    return va == KDATA_BASE || va == KDATA_TIMER_BASE;
+}
+
+/**
+ * @brief Counts a scheduler tick and refreshes the clock. Called from the timer bottom half.
+ */
+void kdata_tick(void);
+
+/**
+ * @brief Publishes the thread the scheduler just switched to.
+ *
+ * @param nr_tasks Number of user tasks alive.
+ */
+void kdata_switch(struct PCB *task, uint32_t nr_tasks);
+
+#endif
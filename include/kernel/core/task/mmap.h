@@ -0,0 +1,92 @@
+#ifndef MMAP_H
+#define MMAP_H
+
+#include <defs.h>
+#include <common/mman.h>
+#include <common/file.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/fs/fat/fat32.h>
+#include <kernel/fs/page_cache.h>
+#include <kernel/core/task/task_defs.h>
+
+// File mapped into a task. Its pages come from the page cache, shared with every other mapping of the file
+typedef struct mmap_area
+{
+    uintptr_t start;    // First virtual address (page aligned)
+    uintptr_t end;      // One past the last virtual address (page aligned)
+    int8_t fd;          // FAT32 descriptor of the mapping itself, used to fill and write back pages
+    uint32_t cluster;   // First cluster of the file, which keys its pages in the cache
+    uint32_t pgoff;     // Page index in the file of the page at start
+    uint32_t file_size; // Size of the file when it was mapped
+    bool writable;
+    struct mmap_area *next;
+} mmap_area_t;
+
+/**
+ * @brief Maps length bytes of a file, from offset on, into the current task (SYS_MMAP).
+ *
+ * Nothing is read here: pages are filled from the page cache as the task
+ * touches them. Writes go to the cached pages, which every task mapping the
+ * file shares, and reach the file on mmap_sync() or mmap_unmap(). Bytes
+ * past the end of the file read as zero and are never written back.
+ *
+ * @param fd     Descriptor of a file on the SD card, open for writing if prot has PROT_WRITE.
+ * @param offset File offset of the first byte, page aligned.
+ * @param prot   PROT_READ, optionally with PROT_WRITE.
+ * @return Address of the mapping, or -1 on failure.
+ */
+int32_t mmap_map(int32_t fd, uint32_t offset, size_t length, uint32_t prot);
+
+/**
+ * @brief Writes back and removes the mapping that starts at va (SYS_MUNMAP).
+ *
+ * @return 0 on success, -1 if nothing is mapped at va or a write-back failed
+ *         (the mapping is removed anyway).
+ */
+int32_t mmap_unmap(uintptr_t va);
+
+/**
+ * @brief Writes back the pages of [va, va + length) written since the last write-back (SYS_MSYNC).
+ *
+ * @return 0 on success, -1 if the range is not mapped or a write-back failed.
+ */
+int32_t mmap_sync(uintptr_t va, size_t length);
+
+/**
+ * @brief Maps the cached file page at va read-only, on a translation fault.
+ *
+ * @return 0 if the page is present, -1 if va is not mapped from a file,
+ *         -2 if the file could not be read, -3 if out of memory.
+ */
+int8_t mmap_fault(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Makes a file page writable on its first write, marking it dirty.
+ *
+ * @return 0 if the write may proceed, -1 if va is not in a writable mapping.
+ */
+int8_t mmap_write_fault(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Returns the mapping of task containing va, or NULL.
+ */
+mmap_area_t *mmap_find(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Writes back and removes every mapping of a task whose address space is torn down.
+ */
+void mmap_unmap_all(struct PCB *task);
+
+/**
+ * @brief Gives dst the mappings of src, each with its own descriptor (fork).
+ *
+ * The pages are shared by copying the page tables. The child's copies start
+ * read-only, so its first write to each page is tracked like any other.
+ *
+ * @return 0 on success, -1 if out of memory or descriptors.
+ */
+int8_t mmap_copy(struct PCB *dst, struct PCB *src);
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef PIPE_H
+#define PIPE_H
+
+#include <defs.h>
+#include <common/string.h>
+#include <kernel/lib/malloc.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/core/task/task_defs.h>
+
+#define PIPE_MAX_PAGES 4    // Largest buffer of a pipe, in pages
+#define PIPE_ATOMIC_MAX 512 // Writes up to this size are never split between readers
+#define PIPE_WOULD_BLOCK -2 // Returned by pipe_read() and pipe_write() when the caller has to wait
+
+struct regs;
+
+typedef struct pipe
+{
+    uint8_t *pages[PIPE_MAX_PAGES]; // Ring buffer, one page after the other
+    uint32_t size;                  // Bytes in the buffer, num_pages * SMALL_PAGE_SIZE
+    uint32_t head;                  // Next byte to read, runs freely
+    uint32_t tail;                  // Next byte to write, runs freely
+    uint32_t readers;               // Descriptors open on the read end, across every task
+    uint32_t writers;               // Descriptors open on the write end
+    struct PCB *waiters;            // Threads sleeping on the pipe, linked through pipe_next
+} pipe_t;
+
+/**
+ * @brief Creates a pipe with a buffer of num_pages pages (1 if 0), a power of two.
+ *
+ * The pipe starts with one reader and one writer, which the caller installs as descriptors.
+ *
+ * @return The pipe, or NULL for a bad size or out of memory.
+ */
+pipe_t *pipe_create(uint32_t num_pages);
+
+/**
+ * @brief Takes a reference on one end of a pipe (fork).
+ */
+void pipe_get(pipe_t *pipe, bool write_end);
+
+/**
+ * @brief Drops a reference on one end of a pipe.
+ *
+ * Closing the last write end wakes readers, which then see end of file.
+ * Closing the last read end wakes writers, which then fail. The pipe is
+ * freed with its last reference.
+ */
+void pipe_put(pipe_t *pipe, bool write_end);
+
+/**
+ * @brief Moves up to n bytes from the pipe to a user buffer.
+ *
+ * @return Bytes read, 0 once the pipe is empty and has no writer left,
+ *         PIPE_WOULD_BLOCK if it is empty, -1 for a bad buffer.
+ */
+int32_t pipe_read(pipe_t *pipe, void *buf, size_t n);
+
+/**
+ * @brief Moves up to n bytes from a user buffer into the pipe.
+ *
+ * Writes of at most PIPE_ATOMIC_MAX bytes go in whole or not at all.
+ *
+ * @return Bytes written, PIPE_WOULD_BLOCK if there is no room,
+ *         -1 if nobody can read the pipe anymore or for a bad buffer.
+ */
+int32_t pipe_write(pipe_t *pipe, const void *buf, size_t n);
+
+/**
+ * @brief Puts the current thread to sleep until the pipe changes, then restarts its syscall.
+ *
+ * @return regs->r0, so the arguments are intact for the restarted call.
+ */
+int32_t pipe_sleep(pipe_t *pipe, struct regs *regs);
+
+/**
+ * @brief Stops a thread from sleeping on a pipe. Called by task_wake().
+ */
+void pipe_cancel(struct PCB *task);
+
+#endif
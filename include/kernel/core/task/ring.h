@@ -0,0 +1,70 @@
+#ifndef RING_H
+#define RING_H
+
+#include <defs.h>
+#include <common/ring.h>
+#include <common/string.h>
+#include <kernel/lib/malloc.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/drivers/timer.h>
+#include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/files.h>
+
+#define RING_MAX_TIMERS 8 // Timeouts in flight per ring
+
+struct regs;
+
+typedef struct ring_timer
+{
+    uint64_t deadline_us;
+    uint32_t user_data;
+} ring_timer_t;
+
+// Kernel side of a task's ring. The ring page itself is only accessed through TASK_RING_BASE
+typedef struct ring_ctx
+{
+    struct PCB *task;   // Leader of the owning task
+    struct PCB *waiter; // Thread sleeping in SYS_ENTER, NULL if none
+    ring_timer_t timers[RING_MAX_TIMERS];
+    uint32_t nr_timers;
+    struct ring_ctx *next;
+} ring_ctx_t;
+
+/**
+ * @brief Maps a zeroed ring page at TASK_RING_BASE in the current task (SYS_RING_SETUP).
+ *
+ * @return TASK_RING_BASE, or -1 if out of memory or the task already has a ring.
+ */
+int32_t ring_setup(void);
+
+/**
+ * @brief Processes the submissions and due timeouts of the current task's ring (SYS_ENTER).
+ *
+ * With RING_ENTER_WAIT in r0, sleeps until a completion is available while
+ * timeouts are pending.
+ *
+ * @return Number of completions waiting to be consumed, or -1 without a ring.
+ */
+int32_t ring_enter(struct regs *regs);
+
+/**
+ * @brief Timer tick work for rings, called from the timer bottom half.
+ *
+ * Wakes threads whose ring has a timeout due. If the tick interrupted a user
+ * task (user is true), that task's ring is processed as by SYS_ENTER, so
+ * submissions complete even if it never traps.
+ */
+void ring_tick(bool user);
+
+/**
+ * @brief Stops a task from waiting in SYS_ENTER. Called by task_exit().
+ */
+void ring_cancel(struct PCB *task);
+
+/**
+ * @brief Frees the ring context of a task whose address space is torn down.
+ */
+void ring_release(struct PCB *task);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <defs.h>
+#include <common/string.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/malloc.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/lib/printk.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/uaccess.h>
+
+#define SHM_NAME_MAX 16 // Longest object name, terminator included
+#define SHM_MAX_PAGES ((TASK_SHM_END - TASK_SHM_BASE) / SMALL_PAGE_SIZE)
+
+// Named shared memory object. Its pages live until the last task detaches
+typedef struct shm
+{
+    char name[SHM_NAME_MAX];
+    size_t num_pages;
+    uintptr_t *pages;   // Physical pages, the object holds one reference on each
+    uint32_t ref_count; // Attachments in all tasks
+    struct shm *next;
+} shm_t;
+
+// Attachment of a shared memory object in a task
+typedef struct shm_map
+{
+    shm_t *shm;
+    uintptr_t va;
+    struct shm_map *next;
+} shm_map_t;
+
+/**
+ * @brief Attaches the shared memory object called name to the current task (SYS_SHM_ATTACH).
+ *
+ * The object is created with size bytes of zeroed memory if it does not exist
+ * yet. Its pages are mapped read/write into the task above TASK_SHM_BASE, the
+ * same physical pages in every task that attaches it. Attaching an object the
+ * task already has returns the existing address.
+ *
+ * @param name Name in user memory.
+ * @param size Size of a new object, or at most the size of an existing one; 0 attaches an existing object whole.
+ * @return Address of the attachment, or -1 on failure.
+ */
+int32_t shm_attach(const char *name, size_t size);
+
+/**
+ * @brief Detaches the object attached at va from the current task (SYS_SHM_DETACH).
+ *
+ * @return 0 on success, -1 if nothing is attached at va.
+ */
+int32_t shm_detach(uintptr_t va);
+
+/**
+ * @brief Detaches every object of a task whose address space is torn down.
+ */
+void shm_detach_all(struct PCB *task);
+
+/**
+ * @brief Gives dst the attachments of src (fork).
+ *
+ * The pages themselves are shared by copying the page tables, which leaves
+ * the shared memory window writable in both tasks.
+ *
+ * @return 0 on success, -1 if out of memory.
+ */
+int8_t shm_copy(struct PCB *dst, struct PCB *src);
+
+#endif
@@ -10,10 +10,16 @@
 #include <kernel/lib/page_alloc.h>
 #include <kernel/core/task/elf/elf.h>
 #include <kernel/core/task/task_defs.h>
+#include <kernel/core/task/vm_region.h>
+#include <kernel/core/task/workqueue.h>
+#include <kernel/drivers/timer.h>
+#include <common/sched_info.h>
 #include <kernel/arch/arm/mmu.h>
 
 #define MAX_TASKS 4
 
+struct regs;
+
 extern struct PCB *current;
 
 void task_init(void);
@@ -21,4 +27,151 @@ int8_t task_create(const char *path, const char *name);
 __attribute__((noreturn)) void task_exit(int32_t status);
 void scheduler(void);
 
+/**
+ * @brief Creates a kernel thread and makes it runnable.
+ *
+ * Kernel threads run entry in system mode on their own stack and on the kernel
+ * page table, so switching to one never needs a user address space. Returning
+ * from entry terminates the thread.
+ *
+ * @return The thread, or NULL if out of memory.
+ */
+struct PCB *kthread_create(void (*entry)(void), const char *name);
+
+/**
+ * @brief Gives up the CPU.
+ *
+ * Raises the PIC software interrupt, which is taken as soon as IRQs are
+ * enabled and runs the scheduler. From a syscall that is right after the
+ * return to user mode.
+ */
+void task_yield(void);
+
+/**
+ * @brief Puts a task in the real-time class, or back in the best-effort one.
+ *
+ * A real-time task runs for up to runtime_us every period_us and is scheduled
+ * earliest-deadline-first ahead of every best-effort task. It is admitted only
+ * if the reserved utilisation of all real-time tasks stays within RT_UTIL_MAX.
+ * A job that uses up its budget is throttled until its next period.
+ *
+ * @param deadline_us Deadline relative to the start of each period, 0 for period_us.
+ * @return 0 on success, -1 for invalid parameters, -2 if the task is not admitted.
+ *         A period of 0 makes the task best-effort again and always succeeds.
+ */
+int8_t sched_set_rt(struct PCB *task, uint32_t period_us, uint32_t runtime_us, uint32_t deadline_us);
+
+/**
+ * @brief Gives up the CPU on behalf of the current task (SYS_YIELD).
+ *
+ * For a real-time task this also ends the current job: it is not scheduled
+ * again before its next period.
+ */
+void sched_yield(void);
+
+/**
+ * @brief Waits for a child of the current task to exit (SYS_WAIT).
+ *
+ * If a child already exited, its status is stored at the user pointer in
+ * regs->r0 (when not NULL) and its PID is returned. If children are still
+ * running, the task blocks and the syscall is restarted once a child exits.
+ *
+ * @return PID of the child, or -1 if the task has no children.
+ */
+int32_t task_wait(struct regs *regs);
+
+/**
+ * @brief Makes a blocked task runnable again.
+ *
+ * The wakeup time is recorded so the scheduler can measure how long the task
+ * waits before it runs.
+ */
+void task_wake(struct PCB *task);
+
+/**
+ * @brief Fills in the scheduling statistics of the task at position index.
+ *
+ * Tasks and kernel threads are numbered in scheduling order; the idle thread comes last.
+ *
+ * @return 0 on success, -1 if there is no task at index.
+ */
+int8_t sched_task_info(uint32_t index, sched_task_info_t *out);
+
+/**
+ * @brief Fills in the global wakeup-to-run latency histogram.
+ */
+void sched_latency_info(sched_latency_info_t *out);
+
+/**
+ * @brief Zeroes the syscall counters of every task (see syscall_stats_reset()).
+ */
+void sched_reset_syscall_stats(void);
+
+/**
+ * @brief Resolves a translation fault inside a task's stack region.
+ *
+ * Stack pages are allocated on demand: the first touch of a stack page maps a
+ * fresh zeroed page. The lowest page of the region is a guard page and is never
+ * mapped, so running off the end of the stack faults instead of corrupting memory.
+ *
+ * @param task Task that faulted.
+ * @param va   Faulting virtual address.
+ *
+ * @return 0 if a page was mapped, -1 if va is outside the stack region,
+ *         -2 if va hit the guard page, -3 if out of memory.
+ */
+int8_t task_stack_fault(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Resolves a translation fault taken by a task.
+ *
+ * Tries the stack region first, then the task's demand-paged regions.
+ *
+ * @return 0 if the faulting page is now mapped, negative if the fault cannot be resolved.
+ */
+int8_t task_page_fault(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Resolves a write to a copy-on-write page.
+ *
+ * Pages shared by fork() are mapped read-only in every task that shares them.
+ * If va lies in writable memory, the page is copied when other mappings still
+ * reference it, or simply made writable again when this task is the last user.
+ *
+ * @return 0 if the page is now writable, -1 if va is not a copy-on-write page,
+ *         -3 if out of memory.
+ */
+int8_t task_cow_fault(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Returns true if va lies in memory the task may write to: its stacks,
+ * shared objects and writable regions.
+ */
+bool task_va_writable(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Duplicates the current task.
+ *
+ * The child gets a copy of the parent's page tables, regions and shared objects.
+ * Writable pages are shared copy-on-write, so nothing is copied until one of the
+ * two tasks writes to a page. The child resumes from the same syscall with r0 = 0.
+ *
+ * @param regs Syscall frame of the parent.
+ * @return PID of the child in the parent, or -1 on failure.
+ */
+int32_t task_fork(struct regs *regs);
+
+/**
+ * @brief Starts a new thread in the address space of the current task.
+ *
+ * The thread gets its own stack slot above TASK_STACK_BASE and shares everything
+ * else with the task. It starts in user mode at regs->r0 (a trampoline) with
+ * r0 = regs->r1 and r1 = regs->r2. The address space is freed once the last
+ * thread of the task has exited.
+ *
+ * @param regs Syscall frame of the caller.
+ * @return PID of the thread, or -1 if the task has no free stack slot.
+ */
+int32_t task_clone(struct regs *regs);
+
 #endif // KERNEL_TASK_H
\ No newline at end of file
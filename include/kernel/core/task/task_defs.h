@@ -3,17 +3,128 @@
 
 #include <defs.h>
 #include <kernel/core/task/elf/elf_defs.h>
+#include <common/kdata.h>
+#include <common/syscall_stats.h>
 
 #define TASK_TEXT_BASE 0x8000000
+#define TASK_MMAP_BASE 0x18000000 // Mapped files, up to TASK_MMAP_END
+#define TASK_MMAP_END TASK_SO_BASE
 #define TASK_SO_BASE 0x20000000
+#define TASK_SHM_BASE 0x28000000 // Shared memory attachments, up to TASK_SHM_END
 #define TASK_STACK_BASE 0x30000000
+#define TASK_RING_BASE (TASK_STACK_BASE - 0x1000) // Submission/completion ring page
+#define TASK_KDATA_BASE KDATA_BASE // Kernel data page, then the clocksource page, both read-only
+#define TASK_SHM_END TASK_KDATA_BASE
 #define TASK_STACK_SIZE 0x100000 // 1MB stack
+#define TASK_STACK_GUARD_SIZE 0x1000 // Lowest stack page is never mapped
+#define TASK_MAX_THREADS 8           // Threads per task, each with a stack slot above TASK_STACK_BASE
+#define TASK_STACKS_END (TASK_STACK_BASE + TASK_MAX_THREADS * TASK_STACK_SIZE)
+#define KTHREAD_STACK_SIZE 0x2000    // Stack of a kernel thread
+#define TASK_MAX_FILES 8             // Descriptors per task, the console ones included
 
-typedef struct l1_free_node
+// Layout of PCB::context, matching the frame built by irq_handler
+#define CTX_SP 0   // Banked SP of the interrupted mode
+#define CTX_LR 1   // Banked LR of the interrupted mode
+#define CTX_SPSR 2 // CPSR of the interrupted code
+#define CTX_R0 3   // r0-r12 occupy CTX_R0 to CTX_R0 + 12
+#define CTX_PC 16  // Address execution resumes at
+#define CTX_WORDS 17
+
+// Kinds of virtual memory region, also used as masks
+#define VM_REGION_SEGMENT 0x1 // Demand-paged ELF segment of the executable
+#define VM_REGION_STACK 0x2   // Stack slot of a thread, filled by task_stack_fault()
+#define VM_REGION_SO 0x4      // Shared object pages, mapped when the object is attached
+#define VM_REGION_ALL 0x7
+
+// Virtual memory region of a task. A task's regions are kept sorted by address
+typedef struct vm_region
+{
+    uintptr_t start;   // First virtual address of the region (page aligned)
+    uintptr_t end;     // One past the last virtual address (page aligned)
+    uint8_t ap;        // Access permissions of the pages in the region
+    uint8_t type;      // VM_REGION_SEGMENT, VM_REGION_STACK or VM_REGION_SO
+    int8_t fd;         // Backing file (-1 for anonymous, zero-filled memory)
+    Elf32_Off offset;  // File offset of the byte mapped at file_va
+    uintptr_t file_va; // Virtual address of the first file-backed byte
+    Elf32_Word filesz; // Number of file-backed bytes; the rest is zero-filled
+    struct vm_region *next;
+} vm_region_t;
+
+// Exit status of a child, kept until the parent waits for it
+typedef struct exit_record
+{
+    uint32_t pid;
+    int32_t status;
+    struct exit_record *next;
+} exit_record_t;
+
+// Scheduler accounting of a task, timestamped with clock_us()
+typedef struct task_stats
+{
+    uint64_t runtime_us;  // Time spent running
+    uint64_t wait_us;     // Time spent ready but not running
+    uint32_t max_wait_us; // Longest single wait
+    uint32_t switches;    // Number of times the task was switched in
+    uint64_t stamp_us;    // When the task last started running or became ready
+} task_stats_t;
+
+#define RT_UTIL_SCALE 1000000 // Utilisation is counted in millionths of the CPU
+#define RT_UTIL_MAX 900000    // Real-time tasks may reserve at most 90%, the rest is left to the others
+
+/*
+ * Real-time (EDF) parameters of a task. A task is real-time if period_us is
+ * non-zero. Every period it may run for runtime_us, and should be done before
+ * deadline_us into the period.
+ */
+typedef struct task_rt
 {
-    uint32_t *l1;
-    struct l1_free_node *next;
-} l1_free_node_t;
+    uint32_t period_us;
+    uint32_t runtime_us;
+    uint32_t deadline_us;  // Relative deadline, at most period_us
+    uint32_t util;         // Reserved share of the CPU, in 1/RT_UTIL_SCALE
+    uint64_t period_end;   // Start of the next job
+    uint64_t deadline;     // Absolute deadline of the current job
+    int64_t budget_us;     // Runtime left in the current job
+    bool done;             // The current job yielded
+    bool throttled;        // The current job used up its budget
+    bool missed;           // The current job is already counted in misses
+    uint32_t misses;       // Jobs not done by their deadline
+    uint32_t overruns;     // Jobs throttled for exceeding their budget
+} task_rt_t;
+
+// Entry of a task's descriptor table
+typedef struct task_file
+{
+    int8_t fd;         // FAT32 descriptor, FILE_CONSOLE, FILE_PIPE or FILE_CLOSED
+    uint32_t flags;    // O_* flags it was opened with
+    struct pipe *pipe; // Pipe of a FILE_PIPE descriptor, its end given by the access mode
+} task_file_t;
+
+#define FILE_CLOSED -1
+#define FILE_CONSOLE -2
+#define FILE_PIPE -3
+
+#define IMAGE_PATH_MAX 64
+
+// Cached executable image, shared by every task started from the same file
+typedef struct image
+{
+    char path[IMAGE_PATH_MAX];
+    uint32_t first_cluster;          // Directory entry metadata the image was loaded from
+    uint32_t file_size;
+    uint16_t modify_date;
+    uint16_t modify_time;
+    uintptr_t entry;                 // Entry point of the executable
+    uintptr_t start;                 // First virtual address covered by pages (page aligned)
+    size_t num_pages;
+    uintptr_t *pages;                // Pristine physical page per virtual page, 0 if not loaded yet
+    vm_region_t *regions;            // Segment template (the fd of each copy is replaced)
+    so_entry_task_t *shared_objs;    // Shared objects the image was relocated against
+    uintptr_t next_so_base;          // next_so_base once all shared objects are mapped
+    size_t ref_count;                // Number of tasks running the image
+    bool stale;                      // Removed from the cache, freed with its last task
+    struct image *next;
+} image_t;
 
 struct PCB
 {
@@ -25,7 +136,7 @@ struct PCB
         BLOCKED,
         TERMINATED
     } state;
-    uint32_t context[17];
+    uint32_t context[CTX_WORDS];
     uint32_t pid;
     int8_t fd;
     uint32_t *pt; // Physical address of L1 page table
@@ -38,6 +149,36 @@ struct PCB
         uintptr_t next_so_base;
     } elf_info;
     so_entry_task_t *shared_objs;
+    vm_region_t *regions; // Segments, stacks and shared objects, sorted by address
+    image_t *image;       // Cached image of the executable, NULL if not cached
+    bool kernel;          // Kernel thread: runs in system mode on the kernel page table
+    void *kstack;         // Stack of a kernel thread
+    task_stats_t stats;
+    syscall_stat_t syscalls; // Syscalls made by this thread, see svc_handler_c()
+    task_rt_t rt;
+    struct PCB *parent;    // Task that forked this one, NULL if created by the kernel or orphaned
+    uint32_t children;     // Children still running
+    exit_record_t *exited; // Exit status of children not waited for yet, oldest first
+
+    /*
+     * Threads share the address space of their leader. Regions, shared objects,
+     * the image and the fd are only valid in the leader; threads copy pt alone.
+     */
+    struct PCB *leader;    // Thread group leader, the task itself for a single-threaded task
+    uint32_t threads;      // Leader only: threads of the group not yet reaped, leader included
+    uint32_t stack_slots;  // Leader only: bitmap of stack slots in use
+    uint8_t stack_slot;    // Stack slot of this thread
+
+    task_file_t files[TASK_MAX_FILES]; // Leader only: descriptors opened by the task
+    struct shm_map *shm_maps;          // Leader only: attached shared memory objects
+    struct mmap_area *mmaps;           // Leader only: mapped files
+
+    uintptr_t futex_key;     // Physical address waited on in futex_wait(), 0 if not waiting
+    struct PCB *futex_next;  // Next waiter in the same futex hash bucket
+    struct ipc_kmsg *ipc_send; // Synchronous message not received yet, NULL if not sending
+    struct ring_ctx *ring;     // Leader only: submission/completion ring, NULL until set up
+    struct pipe *pipe_wait;    // Pipe slept on in read() or write(), NULL if not sleeping
+    struct PCB *pipe_next;     // Next thread sleeping on the same pipe
     char name[11];
     struct PCB *next;
 };
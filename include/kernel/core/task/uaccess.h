@@ -0,0 +1,109 @@
+#ifndef UACCESS_H
+#define UACCESS_H
+
+#include <defs.h>
+#include <common/memory.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/arch/arm/cache.h>
+#include <kernel/core/task/task.h>
+
+#define USER_SPACE_START TASK_TEXT_BASE                  // Lowest address a task may pass to the kernel
+#define USER_SPACE_END TASK_STACKS_END // One past the highest one
+
+/**
+ * @brief Translation of the last user page a copy touched.
+ *
+ * Consecutive accesses to the same page reuse it instead of walking the page
+ * tables again. It stays valid as long as the task's mappings do not change.
+ */
+typedef struct
+{
+    struct PCB *task;
+    uintptr_t page_va; // User page the translation is for
+    uint8_t *page;     // Kernel address of that page, NULL if there is none yet
+    bool write;        // Pages are made privately writable before they are returned
+} user_walk_t;
+
+/**
+ * @brief Starts a walk over the user memory of task.
+ *
+ * @param write Set if the caller writes through the returned addresses.
+ */
+void user_walk_init(user_walk_t *walk, struct PCB *task, bool write);
+
+/**
+ * @brief Returns the kernel address of user address va.
+ *
+ * The page is faulted in if it is missing, and copy-on-write is broken for
+ * walks that write. Nothing is checked against the user range: callers pass
+ * addresses that are already validated or that the kernel chose itself.
+ * Data written through the returned address must be cleaned from the data
+ * cache before the task reads it (see dcache_clean_range()).
+ *
+ * @return Kernel address, or NULL if the task has no page at va.
+ */
+void *user_walk(user_walk_t *walk, uintptr_t va);
+
+/**
+ * @brief Returns true if [p, p + n) lies in the user part of the address space
+ * and the current task is a user task.
+ */
+bool user_range_ok(const void *p, size_t n);
+
+/**
+ * @brief Makes a buffer of the current task present and privately writable.
+ *
+ * Afterwards the kernel may write into the buffer directly, e.g. by letting a
+ * driver fill it, without an intermediate kernel copy.
+ *
+ * @return 0 on success, -1 if the buffer is not writable user memory.
+ */
+int8_t user_prepare_write(void *dst, size_t n);
+
+/**
+ * @brief Makes a buffer of the current task present for reading.
+ *
+ * Afterwards the kernel may read the buffer directly without faulting.
+ *
+ * @return 0 on success, -1 if the buffer is not user memory.
+ */
+int8_t user_prepare_read(const void *src, size_t n);
+
+/**
+ * @brief Copies n bytes from the kernel to a buffer of the current task.
+ *
+ * The page tables are walked once per page. Missing pages are faulted in and
+ * copy-on-write pages are broken before they are written. A privileged write
+ * would otherwise go straight into a page shared with other tasks.
+ *
+ * @return 0 on success, -1 if the buffer is not writable user memory. The
+ *         pages before the first bad one may have been written.
+ */
+int8_t copy_to_user(void *dst, const void *src, size_t n);
+
+/**
+ * @brief Copies n bytes from a buffer of the current task to the kernel.
+ *
+ * A bad user pointer fails the copy instead of aborting in the kernel.
+ *
+ * @return 0 on success, -1 if the buffer is not user memory.
+ */
+int8_t copy_from_user(void *dst, const void *src, size_t n);
+
+/**
+ * @brief Returns the length of a NUL terminated string of the current task.
+ *
+ * @return Length of the string, max if there is no terminator within max
+ *         bytes, or -1 if the string is not in user memory.
+ */
+int32_t strnlen_user(const char *s, size_t max);
+
+/**
+ * @brief Copies a NUL terminated string of the current task into dst.
+ *
+ * @param max Size of dst, terminator included.
+ * @return Length of the string, or -1 if it is not in user memory or too long.
+ */
+int32_t strncpy_from_user(char *dst, const char *src, size_t max);
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef VM_REGION_H
+#define VM_REGION_H
+
+#include <defs.h>
+#include <common/memory.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/arch/arm/cache.h>
+#include <kernel/fs/fat/fat32.h>
+#include <kernel/core/task/task_defs.h>
+
+/**
+ * @brief Records a region of a task's address space, keeping the list sorted.
+ *
+ * Nothing is mapped here: stacks are filled by task_stack_fault() and shared
+ * object pages by the loader. The region has no backing file.
+ *
+ * @param start First address of the region, rounded down to a page.
+ * @param end   One past the last address, rounded up to a page.
+ * @param type  VM_REGION_SEGMENT, VM_REGION_STACK or VM_REGION_SO.
+ *
+ * @return The new region, or NULL if it could not be allocated.
+ */
+vm_region_t *vm_region_insert(struct PCB *task, uintptr_t start, uintptr_t end, uint8_t ap, uint8_t type);
+
+/**
+ * @brief Records a demand-paged ELF segment in a task's address space.
+ *
+ * Nothing is allocated or read here. Pages of the region are filled by
+ * vm_region_fault() the first time they are touched.
+ *
+ * @param task    Task that owns the region.
+ * @param va      Virtual address of the first byte of the region (need not be page aligned).
+ * @param memsz   Size of the region in bytes.
+ * @param ap      Access permissions for the pages of the region.
+ * @param fd      Backing file, or -1 for zero-filled memory.
+ * @param offset  File offset of the byte mapped at va.
+ * @param filesz  Number of bytes backed by the file. Bytes past filesz read as zero.
+ *
+ * @return The new region, or NULL if it could not be allocated.
+ */
+vm_region_t *vm_region_add(struct PCB *task, uintptr_t va, size_t memsz, uint8_t ap, int8_t fd, Elf32_Off offset, Elf32_Word filesz);
+
+/**
+ * @brief Finds the region of a task that contains a virtual address.
+ *
+ * @return The region, or NULL if va is not inside any region.
+ */
+vm_region_t *vm_region_find(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Unmaps a region and frees its descriptor.
+ *
+ * The task's reference to every page mapped in the region is dropped, so
+ * pages still shared with other tasks survive. Coarse page tables are kept.
+ */
+void vm_region_remove(struct PCB *task, vm_region_t *region);
+
+/**
+ * @brief Removes every region of a task whose type is in the mask types.
+ */
+void vm_region_remove_all(struct PCB *task, uint8_t types);
+
+/**
+ * @brief Makes the page containing va present in the task's page table.
+ *
+ * If the page is already mapped nothing happens. If the task's executable image
+ * is cached and already holds the page, that page is shared read-only.
+ * Otherwise a zeroed page is allocated, the file-backed bytes of every region
+ * overlapping the page are read into it, and it is mapped with the permissions
+ * of those regions. Pages added to the image cache are mapped read-only so that
+ * writes to them are copied.
+ *
+ * @return 0 if the page is present, -1 if va is not inside a segment,
+ *         -2 if the backing file could not be read, -3 if out of memory.
+ */
+int8_t vm_region_fault(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Returns true if any region overlapping the page at va is writable.
+ */
+bool vm_region_writable(struct PCB *task, uintptr_t va);
+
+/**
+ * @brief Inserts a copy of every region of src whose type is in the mask types into the sorted list at dst.
+ *
+ * @return 0 on success, -1 if out of memory.
+ */
+int8_t vm_region_copy_list(vm_region_t **dst, vm_region_t *src, uint8_t types);
+
+/**
+ * @brief Copies the region descriptors of src into dst.
+ *
+ * Regions keep their backing file descriptor; callers that give dst its own
+ * descriptor must patch the copies.
+ *
+ * @return 0 on success, -1 if out of memory.
+ */
+int8_t vm_region_copy_all(struct PCB *dst, struct PCB *src);
+
+/**
+ * @brief Frees every region descriptor of a list and empties it.
+ */
+void vm_region_free_list(vm_region_t **list);
+
+#endif
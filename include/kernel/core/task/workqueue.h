@@ -0,0 +1,36 @@
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include <defs.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/printk.h>
+#include <kernel/arch/arm/interrupt.h>
+
+typedef void (*work_fn_t)(void *arg);
+
+typedef struct work
+{
+    work_fn_t fn;
+    void *arg;
+    struct work *next;
+} work_t;
+
+/**
+ * @brief Starts the worker thread that runs queued work.
+ *
+ * Must be called after task_init().
+ */
+void workqueue_init(void);
+
+/**
+ * @brief Defers fn(arg) to the worker thread.
+ *
+ * Safe to call from IRQ and syscall context. Work runs in FIFO order on the
+ * kernel page table, with IRQs masked like any other kernel code; the worker
+ * can be preempted between items.
+ *
+ * @return 0 on success, -1 if the work item could not be allocated.
+ */
+int8_t queue_work(work_fn_t fn, void *arg);
+
+#endif
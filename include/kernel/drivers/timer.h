@@ -1,6 +1,7 @@
 #ifndef TIMER_H
 #define TIMER_H
 #include <stdint.h>
+#include <stddef.h>
 #include <kernel/hw/timer.h>
 
 #define TIMER0_START() (timer0->control |= TIMER_ENABLE)
@@ -13,4 +14,37 @@ void timer0_init(uint32_t load_value, uint8_t mode, uint8_t ie, uint8_t prescale
 void timer1_init(uint32_t load_value, uint8_t mode, uint8_t ie, uint8_t prescaler, uint8_t size, uint8_t oneshot);
 void timer2_init(uint32_t load_value, uint8_t mode, uint8_t ie, uint8_t prescaler, uint8_t size, uint8_t oneshot);
 
+/**
+ * @brief Starts timer 2 as a free-running 1MHz clocksource.
+ *
+ * Timer 2 counts down from 0xFFFFFFFF and wraps, without raising interrupts.
+ */
+void clocksource_init(void);
+
+/**
+ * @brief Returns the number of microseconds since clocksource_init().
+ *
+ * The 32-bit counter is extended to 64 bits in software, so the clock must be
+ * read at least once per wrap (about 71 minutes). The scheduler tick does that.
+ */
+uint64_t clock_us(void);
+
+/**
+ * @brief Like clock_us(), also returning the counter value the time was read at.
+ *
+ * Lets user space extend the time from the counter itself (see common/kdata.h).
+ */
+uint64_t clock_us_count(uint32_t *count);
+
+/**
+ * @brief Returns the raw clocksource counter, which counts down at 1MHz.
+ *
+ * Cheaper than clock_us() for short intervals: (uint32_t)(start - end) is
+ * the number of microseconds between two reads less than 71 minutes apart.
+ */
+static inline uint32_t clock_counter(void)
+{
+    return timer2->value;
+}
+
 #endif
\ No newline at end of file
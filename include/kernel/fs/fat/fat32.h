@@ -12,7 +12,7 @@
 #define ENTRIES_PER_SECTOR (SECTOR_SIZE / DIR_ENTRY_SIZE)
 #define FAT32_EOC ((uint32_t)0x0FFFFFF8)
 #define ENTRY_UNUSED 0xE5
-#define MAX_OPEN_FILES 3
+#define MAX_OPEN_FILES 32 // Shared by every task: executables, shared objects and user files
 #define FAT_ENTRY_SIZE 32
 #define MAX_PATH_DEPTH 32
 
@@ -118,6 +118,7 @@ int8_t fat32_open(const char *path);
  * - The function updates the file's current position and cluster as data is read.
  * - It assumes the FAT32 file system is properly initialized and accessible.
  * - The buffer must be large enough to hold the requested number of bytes.
+ * - Whole sectors are read by the SD driver straight into buf when it is word aligned.
  * - Reading beyond the end of the file will not cause an error but will return fewer bytes.
  */
 int32_t fat32_read(int8_t fd, void *buf, size_t size);
@@ -146,6 +147,18 @@ int32_t fat32_read(int8_t fd, void *buf, size_t size);
  */
 int8_t fat32_seek(int8_t fd, int32_t offset, seek_op_t op);
 
+/**
+ * @brief Returns the current position in an open file, or -1 if fd is not open.
+ */
+int32_t fat32_tell(int8_t fd);
+
+/**
+ * @brief Copies the directory entry of an open file, as of its last write.
+ *
+ * @return 0 on success, -1 if fd is not open.
+ */
+int8_t fat32_fstat(int8_t fd, fat32_dir_entry_t *out);
+
 /**
  * @brief Creates a new file in the FAT32 filesystem at the specified path.
  *
@@ -194,6 +207,17 @@ int32_t fat32_write(int8_t fd, uint8_t *buf, size_t size);
 
 int8_t fat32_create_directory(const char *path);
 int8_t fat32_close(int8_t fd);
+
+/**
+ * @brief Duplicates an open file into a new file table slot.
+ *
+ * The new descriptor refers to the same file and starts at the same position,
+ * but seeks and closes on one descriptor do not affect the other.
+ *
+ * @param fd The descriptor to duplicate.
+ * @return The new descriptor, or -1 if fd is not open or the file table is full.
+ */
+int8_t fat32_dup(int8_t fd);
 int8_t fat32_delete(const char *path);
 int8_t fat32_truncate(int8_t fd, uint32_t new_size);
 int8_t fat32_stat(const char *path, fat32_dir_entry_t *out);
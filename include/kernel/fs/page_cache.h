@@ -0,0 +1,59 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <defs.h>
+#include <common/string.h>
+#include <kernel/lib/slab.h>
+#include <kernel/lib/page_alloc.h>
+#include <kernel/lib/printk.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/arch/arm/cache.h>
+#include <kernel/fs/fat/fat32.h>
+
+#define PAGE_CACHE_BUCKETS 32 // Power of two
+#define PAGE_CACHE_MAX 64     // Pages kept before unused ones are evicted
+
+// Page of file data, shared by every task that maps it
+typedef struct page_cache_entry
+{
+    uint32_t cluster; // First cluster of the file
+    uint32_t index;   // Page index in the file
+    uintptr_t page;   // Physical page. The cache holds one reference, each mapping another
+    bool dirty;       // Written since the last write-back
+    uint32_t writers; // Mappings that have the page writable
+    struct page_cache_entry *next;
+} page_cache_entry_t;
+
+/**
+ * @brief Returns the cached page index of the file starting at cluster, reading it through fd if needed.
+ *
+ * Bytes past file_size read as zero. When the cache is full, a page that no
+ * task maps and that is clean is evicted first.
+ *
+ * @return The entry, or NULL if the file could not be read or out of memory.
+ */
+page_cache_entry_t *page_cache_get(int8_t fd, uint32_t cluster, uint32_t index, uint32_t file_size);
+
+/**
+ * @brief Returns the cached page index of the file starting at cluster, or NULL if it is not cached.
+ */
+page_cache_entry_t *page_cache_find(uint32_t cluster, uint32_t index);
+
+/**
+ * @brief Writes a dirty page back through fd. Bytes past file_size are not written.
+ *
+ * The page stays dirty while some mapping still has it writable.
+ *
+ * @return 0 on success, -1 if the write failed.
+ */
+int8_t page_cache_writeback(page_cache_entry_t *entry, int8_t fd, uint32_t file_size);
+
+/**
+ * @brief Drops the clean pages of a file that no task maps.
+ *
+ * Called when the file changes through write() or truncation. Pages still
+ * mapped keep the data they had.
+ */
+void page_cache_invalidate(uint32_t cluster);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef HW_CM_H
+#define HW_CM_H
+
+#include <defs.h>
+
+// Integrator core module register definitions (only the ones the kernel reads)
+typedef struct
+{
+    volatile uint32_t ID;       // 0x00
+    volatile uint32_t PROC;     // 0x04
+    volatile uint32_t OSC;      // 0x08
+    volatile uint32_t CTRL;     // 0x0C
+    volatile uint32_t STAT;     // 0x10
+    volatile uint32_t LOCK;     // 0x14
+    volatile uint32_t LMBUSCNT; // 0x18
+    volatile uint32_t AUXOSC;   // 0x1C
+    volatile uint32_t SDRAM;    // 0x20
+} cm_t;
+
+#define CM_BASE 0x10000000
+#define cm ((cm_t *)CM_BASE)
+
+// CM_ID: bits 31:24 hold the manufacturer, ARM for a core module
+#define CM_ID_MANUFACTURER(val) ((val) >> 24)
+#define CM_ID_ARM 0x41
+
+// CM_SDRAM: bits 4:2 give the size of the SDRAM module, 16 MB << n. Encodings above 256 MB are reserved
+#define CM_SDRAM_SIZE_SHIFT 2
+#define CM_SDRAM_SIZE_MASK 0x7
+#define CM_SDRAM_SIZE_MAX 4
+#define CM_SDRAM_SIZE_FIELD(val) (((val) >> CM_SDRAM_SIZE_SHIFT) & CM_SDRAM_SIZE_MASK)
+#define CM_SDRAM_SIZE(val) (0x1000000u << CM_SDRAM_SIZE_FIELD(val))
+
+#endif
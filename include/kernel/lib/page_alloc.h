@@ -16,13 +16,51 @@
 typedef struct
 {
     uint32_t *bitmap;
+    uint16_t *refs; // Reference count of every page (number of mappings that share it)
     size_t num_pages;
     size_t page_size;
     uintptr_t base_addr;
 } PageAllocator;
 
+/**
+ * @brief Sets up allocator n over num_pages pages of page_size bytes at base_addr.
+ *
+ * The bitmap and reference counts are stored in the first pages of the pool,
+ * which stay allocated, so the pool must already be mapped.
+ */
 void init_page_allocator(uint8_t n, size_t num_pages, size_t page_size, uintptr_t base_addr);
 void *alloc_page(uint8_t n);
 void free_page(uint8_t n, void *addr);
 
+/**
+ * @brief Allocates count physically contiguous pages, aligned to their total size.
+ *
+ * Used to back large pages and sections, which need naturally aligned physical
+ * memory, so count must be a power of two. Every page of the run gets its own
+ * reference count of one and is released with page_put() or free_page() like
+ * any other page.
+ *
+ * @return Address of the first page, or NULL if no aligned run is free.
+ */
+void *alloc_pages(uint8_t n, size_t count);
+
+/**
+ * @brief Takes an extra reference on an allocated page.
+ *
+ * Pages start with a reference count of one when returned by alloc_page().
+ * Every additional mapping of the page (shared or copy-on-write) must take a
+ * reference so the page is only freed once the last mapping is gone.
+ */
+void page_get(uint8_t n, void *addr);
+
+/**
+ * @brief Drops a reference on a page, freeing it when the count reaches zero.
+ */
+void page_put(uint8_t n, void *addr);
+
+/**
+ * @brief Returns the reference count of a page, or 0 if it is not allocated.
+ */
+uint16_t page_ref_count(uint8_t n, void *addr);
+
 #endif
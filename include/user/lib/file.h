@@ -0,0 +1,75 @@
+#ifndef USER_FILE_H
+#define USER_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <user/lib/syscall.h>
+#include <common/file.h>
+
+// Origins of lseek()
+#define SEEK_SET 0
+#define SEEK_CUR 1
+#define SEEK_END 2
+
+/**
+ * @brief Opens a file on the SD card.
+ *
+ * @param flags O_RDONLY, O_WRONLY or O_RDWR, optionally with O_CREAT, O_TRUNC and O_APPEND.
+ * @return A descriptor, or -1 on failure.
+ */
+int32_t open(const char *path, uint32_t flags);
+
+/**
+ * @brief Reads up to n bytes from a descriptor into buf.
+ *
+ * @return Bytes read, 0 at end of file, -1 on failure,
+ *         -2 if the descriptor is an empty O_NONBLOCK pipe.
+ */
+int32_t read(int32_t fd, void *buf, size_t n);
+
+/**
+ * @brief Writes n bytes of buf to a descriptor.
+ *
+ * @return Bytes written, -1 on failure, -2 if the descriptor is a full O_NONBLOCK pipe.
+ */
+int32_t write(int32_t fd, const void *buf, size_t n);
+
+/**
+ * @brief Moves the position of a descriptor.
+ *
+ * @return The new position, or -1 on failure.
+ */
+int32_t lseek(int32_t fd, int32_t offset, uint32_t whence);
+
+/**
+ * @brief Closes a descriptor.
+ */
+int32_t close(int32_t fd);
+
+/**
+ * @brief Creates a pipe: fds[0] reads what is written to fds[1].
+ *
+ * Reads sleep while the pipe is empty and return 0 once every write end is
+ * closed. Writes sleep while it is full and fail once every read end is
+ * closed. Writes of up to 512 bytes are never split. The descriptors are
+ * inherited by fork().
+ *
+ * @param flags     O_NONBLOCK to get -2 instead of sleeping.
+ * @param num_pages Buffer size in 4KB pages: 1, 2 or 4 (0 for 1).
+ * @return 0 on success, -1 on failure.
+ */
+int32_t pipe_create(int32_t fds[2], uint32_t flags, uint32_t num_pages);
+
+/**
+ * @brief Creates a blocking pipe with a one page buffer, see pipe_create().
+ */
+int32_t pipe(int32_t fds[2]);
+
+/**
+ * @brief Fills st with the size, attributes and modification time of path.
+ *
+ * @return 0 on success, -1 if path does not exist.
+ */
+int32_t stat(const char *path, stat_t *st);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef USER_FUTEX_H
+#define USER_FUTEX_H
+
+#include <stdint.h>
+#include <user/lib/syscall.h>
+
+/**
+ * @brief Sleeps until woken on uaddr, unless *uaddr no longer equals expected.
+ *
+ * @return 0 when woken (possibly spuriously, so recheck the condition),
+ *         -2 if the value had already changed, -1 for a bad address.
+ */
+int32_t futex_wait(volatile uint32_t *uaddr, uint32_t expected);
+
+/**
+ * @brief Wakes up to count threads sleeping on uaddr.
+ *
+ * @return Number of threads woken, or -1 for a bad address.
+ */
+int32_t futex_wake(volatile uint32_t *uaddr, uint32_t count);
+
+// Lock that only enters the kernel when contended. Initialise to MUTEX_INIT
+typedef struct mutex
+{
+    volatile uint32_t state; // 0 unlocked, 1 locked, 2 locked with possible waiters
+} mutex_t;
+
+#define MUTEX_INIT {0}
+
+void mutex_lock(mutex_t *m);
+void mutex_unlock(mutex_t *m);
+
+#endif
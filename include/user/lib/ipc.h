@@ -0,0 +1,42 @@
+#ifndef USER_IPC_H
+#define USER_IPC_H
+
+#include <stdint.h>
+#include <user/lib/syscall.h>
+#include <common/ipc.h>
+
+/**
+ * @brief Creates a port that only the calling task can receive from.
+ *
+ * @return The port number, or -1 if no port is free.
+ */
+int32_t port_create(void);
+
+/**
+ * @brief Destroys a port created by the calling task. Pending messages are dropped.
+ */
+int32_t port_destroy(int32_t port);
+
+/**
+ * @brief Sends msg to a port.
+ *
+ * msg->len bytes of msg->data are copied. msg->num_pages page aligned pages at
+ * msg->pages are moved to the receiver without copying; the caller's range
+ * reads back as fresh memory afterwards. Without IPC_ASYNC the call returns
+ * once the message has been received.
+ *
+ * @return 0 on success, -1 on failure, -2 if the port is full.
+ */
+int32_t port_send(int32_t port, const ipc_msg_t *msg, uint32_t flags);
+
+/**
+ * @brief Receives the oldest message of a port into msg.
+ *
+ * Set msg->pages and msg->num_pages to a page aligned window that receives a
+ * page payload. Without IPC_NONBLOCK the call waits for a message.
+ *
+ * @return 0 on success, -1 on failure, -2 if the port is empty.
+ */
+int32_t port_receive(int32_t port, ipc_msg_t *msg, uint32_t flags);
+
+#endif
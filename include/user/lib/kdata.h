@@ -0,0 +1,37 @@
+#ifndef USER_KDATA_H
+#define USER_KDATA_H
+
+#include <stdint.h>
+#include <common/kdata.h>
+
+/*
+ * Readers of the kernel data page. None of them enters the kernel, so they
+ * are cheap enough to timestamp hot paths.
+ */
+
+/**
+ * @brief Copies a consistent snapshot of the kernel data page.
+ */
+void kdata_read(kdata_t *out);
+
+/**
+ * @brief Returns the number of microseconds since boot. Monotonic.
+ */
+uint64_t clock_us(void);
+
+/**
+ * @brief Returns the PID of the calling task, the one fork() and wait() report.
+ */
+uint32_t getpid(void);
+
+/**
+ * @brief Returns the PID of the calling thread, the one thread_create() reports.
+ */
+uint32_t gettid(void);
+
+/**
+ * @brief Returns the number of scheduler ticks since boot.
+ */
+uint64_t sched_ticks(void);
+
+#endif
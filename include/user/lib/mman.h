@@ -0,0 +1,39 @@
+#ifndef USER_MMAN_H
+#define USER_MMAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <user/lib/syscall.h>
+#include <common/mman.h>
+
+#define MAP_FAILED ((void *)-1)
+
+/**
+ * @brief Maps length bytes of an open file, from offset on, into the calling task.
+ *
+ * Pages are read from the SD card the first time they are touched and shared
+ * with every task that maps the same file. Writes reach the file on msync()
+ * or munmap(), and when the task exits. Writes through write() are not seen
+ * by pages that are already mapped. Mappings never change the file size.
+ *
+ * @param prot   PROT_READ, optionally with PROT_WRITE (fd must then be open for writing).
+ * @param offset Page aligned offset in the file.
+ * @return The mapping, or MAP_FAILED.
+ */
+void *mmap(size_t length, uint32_t prot, int32_t fd, uint32_t offset);
+
+/**
+ * @brief Writes back and removes the mapping returned by mmap() at addr.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int32_t munmap(void *addr);
+
+/**
+ * @brief Writes the modified pages of [addr, addr + length) back to the file.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int32_t msync(void *addr, size_t length);
+
+#endif
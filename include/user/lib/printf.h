@@ -6,8 +6,38 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <user/lib/syscall.h>
+#include <user/lib/file.h>
+#include <user/lib/futex.h>
 #include <common/string.h>
 
+#define STDOUT_BUF_SIZE 1024
+
+// Buffering modes of stdout
+#define STDOUT_UNBUFFERED 0 // Every printf() is written at once
+#define STDOUT_LINE 1       // Written when a line is complete or the buffer is full (default)
+#define STDOUT_FULL 2       // Written when the buffer is full
+
+/**
+ * @brief Formats to stdout.
+ *
+ * Output is collected in a buffer and written with one SYS_WRITE per flush.
+ *
+ * @return Number of characters printed, or -1 on failure.
+ */
 int printf(const char *fmt, ...);
 
+/**
+ * @brief Writes out whatever stdout holds. exit() and fork() call it.
+ *
+ * @return 0 on success, -1 if the write failed.
+ */
+int stdout_flush(void);
+
+/**
+ * @brief Selects STDOUT_UNBUFFERED, STDOUT_LINE or STDOUT_FULL. Pending output is flushed first.
+ *
+ * @return 0 on success, -1 for an unknown mode.
+ */
+int stdout_set_buffering(int mode);
+
 #endif
\ No newline at end of file
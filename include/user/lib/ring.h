@@ -0,0 +1,43 @@
+#ifndef USER_RING_H
+#define USER_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <user/lib/syscall.h>
+#include <common/ring.h>
+
+/**
+ * @brief Maps the submission/completion ring of the calling task.
+ *
+ * @return The ring, or NULL on failure (including a second call).
+ */
+ring_t *ring_setup(void);
+
+/**
+ * @brief Queues a copy of sqe without entering the kernel.
+ *
+ * @return 0 on success, -1 if the submission ring is full.
+ */
+int32_t ring_submit(ring_t *ring, const ring_sqe_t *sqe);
+
+/**
+ * @brief Has the kernel process every queued submission with one trap.
+ *
+ * Submissions are also processed on timer ticks that interrupt the task.
+ *
+ * @param flags RING_ENTER_WAIT to sleep until a completion is available.
+ * @return Number of completions waiting, or -1 on failure.
+ */
+int32_t ring_enter(uint32_t flags);
+
+/**
+ * @brief Returns the oldest unconsumed completion, or NULL if there is none.
+ */
+ring_cqe_t *ring_peek_cqe(ring_t *ring);
+
+/**
+ * @brief Consumes the completion returned by ring_peek_cqe().
+ */
+void ring_cqe_seen(ring_t *ring);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef USER_SHM_H
+#define USER_SHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <user/lib/syscall.h>
+
+/**
+ * @brief Maps the shared memory object called name, creating it if needed.
+ *
+ * Every task that attaches the same name sees the same memory. A new object
+ * is size bytes of zeroes. Names are at most 15 characters.
+ *
+ * @param size Size of a new object, 0 to attach an existing one whole.
+ * @return Address of the memory, or NULL on failure.
+ */
+void *shm_attach(const char *name, size_t size);
+
+/**
+ * @brief Unmaps memory returned by shm_attach().
+ *
+ * The object is destroyed once no task has it attached.
+ *
+ * @return 0 on success, -1 if nothing is attached at addr.
+ */
+int32_t shm_detach(void *addr);
+
+#endif
@@ -15,6 +15,110 @@
 #define SYS_READ 3
 #endif
 
+#ifndef SYS_FORK
+#define SYS_FORK 4
+#endif
+
+#ifndef SYS_SCHED_INFO
+#define SYS_SCHED_INFO 5
+#endif
+
+#ifndef SYS_YIELD
+#define SYS_YIELD 6
+#endif
+
+#ifndef SYS_WAIT
+#define SYS_WAIT 7
+#endif
+
+#ifndef SYS_CLONE
+#define SYS_CLONE 8
+#endif
+
+#ifndef SYS_SCHED_SETRT
+#define SYS_SCHED_SETRT 9
+#endif
+
+#ifndef SYS_OPEN
+#define SYS_OPEN 10
+#endif
+
+#ifndef SYS_WRITE
+#define SYS_WRITE 11
+#endif
+
+#ifndef SYS_LSEEK
+#define SYS_LSEEK 12
+#endif
+
+#ifndef SYS_CLOSE
+#define SYS_CLOSE 13
+#endif
+
+#ifndef SYS_STAT
+#define SYS_STAT 14
+#endif
+
+#ifndef SYS_SHM_ATTACH
+#define SYS_SHM_ATTACH 15
+#endif
+
+#ifndef SYS_SHM_DETACH
+#define SYS_SHM_DETACH 16
+#endif
+
+#ifndef SYS_FUTEX_WAIT
+#define SYS_FUTEX_WAIT 17
+#endif
+
+#ifndef SYS_FUTEX_WAKE
+#define SYS_FUTEX_WAKE 18
+#endif
+
+#ifndef SYS_PORT_CREATE
+#define SYS_PORT_CREATE 19
+#endif
+
+#ifndef SYS_PORT_DESTROY
+#define SYS_PORT_DESTROY 20
+#endif
+
+#ifndef SYS_PORT_SEND
+#define SYS_PORT_SEND 21
+#endif
+
+#ifndef SYS_PORT_RECV
+#define SYS_PORT_RECV 22
+#endif
+
+#ifndef SYS_RING_SETUP
+#define SYS_RING_SETUP 23
+#endif
+
+#ifndef SYS_ENTER
+#define SYS_ENTER 24
+#endif
+
+#ifndef SYS_PIPE
+#define SYS_PIPE 25
+#endif
+
+#ifndef SYS_MMAP
+#define SYS_MMAP 26
+#endif
+
+#ifndef SYS_MUNMAP
+#define SYS_MUNMAP 27
+#endif
+
+#ifndef SYS_MSYNC
+#define SYS_MSYNC 28
+#endif
+
+#ifndef SYS_SYSCALL_STATS
+#define SYS_SYSCALL_STATS 29
+#endif
+
 int32_t syscall(int32_t num, int32_t arg0, int32_t arg1, int32_t arg2, int32_t arg3);
 
 #endif
\ No newline at end of file
@@ -3,7 +3,87 @@
 
 #include <stdint.h>
 #include <user/lib/syscall.h>
+#include <user/lib/printf.h>
+#include <common/sched_info.h>
+#include <common/syscall_stats.h>
 
 __attribute__((noreturn)) void exit(void);
 
+/**
+ * @brief Terminates the calling task with an exit status for its parent.
+ */
+__attribute__((noreturn)) void _exit(int32_t status);
+
+/**
+ * @brief Gives the CPU to another ready task.
+ *
+ * A real-time task calls this when its job for the current period is done.
+ */
+void yield(void);
+
+/**
+ * @brief Blocks until a child exits.
+ *
+ * @param status Receives the child's exit status, may be NULL.
+ * @return PID of the child, or -1 if the task has no children.
+ */
+int32_t wait(int32_t *status);
+
+/**
+ * @brief Creates a copy of the calling task.
+ *
+ * @return PID of the child in the parent, 0 in the child, -1 on failure.
+ */
+int32_t fork(void);
+
+/**
+ * @brief Starts a thread running fn(arg) in the address space of the calling task.
+ *
+ * The thread exits with the return value of fn. Up to 8 threads,
+ * the main one included, can run at once.
+ *
+ * @return PID of the thread, or -1 on failure.
+ */
+int32_t thread_create(int32_t (*fn)(void *), void *arg);
+
+/**
+ * @brief Makes the calling thread real-time: runtime_us of CPU every period_us,
+ * done within deadline_us (0 for the whole period) of the start of each period.
+ *
+ * Real-time threads run earliest-deadline-first ahead of all others and are
+ * throttled when they overrun their runtime. A period of 0 makes the thread
+ * best-effort again.
+ *
+ * @return 0 on success, -1 for invalid parameters, -2 if the CPU is already too reserved.
+ */
+int32_t sched_set_rt(uint32_t period_us, uint32_t runtime_us, uint32_t deadline_us);
+
+/**
+ * @brief Reads the scheduling statistics of the task at position index.
+ *
+ * @return 0 on success, -1 if there is no task at index.
+ */
+int32_t sched_task_info(uint32_t index, sched_task_info_t *out);
+
+/**
+ * @brief Reads the global wakeup-to-run latency histogram.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int32_t sched_latency_info(sched_latency_info_t *out);
+
+/**
+ * @brief Reads the call count and kernel time of every syscall.
+ *
+ * Per-thread totals are in sched_task_info_t.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int32_t syscall_stats(syscall_stats_t *out);
+
+/**
+ * @brief Zeroes the syscall counters, the per-thread ones included.
+ */
+int32_t syscall_stats_reset(void);
+
 #endif
\ No newline at end of file
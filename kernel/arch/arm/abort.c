@@ -0,0 +1,80 @@
+#include <kernel/arch/arm/abort.h>
+#include <kernel/arch/arm/interrupt.h>
+#include <kernel/arch/arm/softirq.h>
+#include <common/abort.h>
+
+static const char *fsr_to_string(uint8_t status)
+{
+    switch (status)
+    {
+    case FSR_ALIGNMENT:
+    case FSR_ALIGNMENT_ALT:
+        return "alignment";
+    case FSR_TRANSLATION_SECTION:
+        return "section translation";
+    case FSR_TRANSLATION_PAGE:
+        return "page translation";
+    case FSR_DOMAIN_SECTION:
+        return "section domain";
+    case FSR_DOMAIN_PAGE:
+        return "page domain";
+    case FSR_PERMISSION_SECTION:
+        return "section permission";
+    case FSR_PERMISSION_PAGE:
+        return "page permission";
+    case FSR_EXT_LINEFETCH_SECTION:
+    case FSR_EXT_LINEFETCH_PAGE:
+    case FSR_EXT_SECTION:
+    case FSR_EXT_PAGE:
+        return "external abort";
+    case FSR_EXT_L1_WALK:
+    case FSR_EXT_L2_WALK:
+        return "external abort on translation";
+    default:
+        return "unknown";
+    }
+}
+
+void data_abort_handler_c(regs_t *regs, uintptr_t far, uint32_t fsr)
+{
+    uint8_t status = FSR_STATUS(fsr);
+    uint8_t mode = regs->spsr & CPSR_MODE_MASK;
+
+    // Demand paging: a missing translation inside one of the task's regions
+    if (current && FSR_IS_TRANSLATION(status) && task_page_fault(current, far) == 0)
+        return; // Retry the aborted instruction
+
+    // Copy-on-write: a user write to a page or section shared read-only by fork()
+    if (current && mode == CPSR_MODE_USR && FSR_IS_PERMISSION(status) && task_cow_fault(current, far) == 0)
+        return;
+
+    printk("Data abort (%s) at pc %p: addr %p, fsr 0x%x, domain %u\n",
+           fsr_to_string(status), regs->lr, far, fsr, FSR_DOMAIN(fsr));
+
+    // Faults taken in user mode, or in a syscall on behalf of a task, kill the task.
+    // A fault in interrupt context would leave the softirq and PIC state behind, so it halts
+    bool in_interrupt = irq_in_progress() || softirq_in_progress();
+    if (current && (mode == CPSR_MODE_USR || (mode == CPSR_MODE_SVC && !in_interrupt)))
+        task_exit(-1);
+
+    printk("Kernel data abort, halting\n");
+    abort();
+}
+
+void prefetch_abort_handler_c(regs_t *regs, uint32_t ifsr)
+{
+    uint8_t status = FSR_STATUS(ifsr);
+    uintptr_t pc = regs->lr;
+
+    // Instruction fetch from a demand-paged segment that has not been loaded yet
+    if (current && FSR_IS_TRANSLATION(status) && task_page_fault(current, pc) == 0)
+        return;
+
+    printk("Prefetch abort (%s) at pc %p, ifsr 0x%x\n", fsr_to_string(status), pc, ifsr);
+
+    if (current && (regs->spsr & CPSR_MODE_MASK) == CPSR_MODE_USR)
+        task_exit(-1);
+
+    printk("Kernel prefetch abort, halting\n");
+    abort();
+}
@@ -16,6 +16,8 @@ fine_page_table:
 .global _start
 
 _start:
+    mov r4, r2              /* Keep the ATAG pointer for mem_init */
+
     /* Copy .data from LMA (ROM) to VMA (RAM) */
     ldr r0, =_data_load     /* ROM source */
     ldr r1, =_data_start    /* RAM destination */
@@ -51,6 +53,14 @@ zero_bss:
     
     ldr sp, =_svc_stack_top
 
+    /* Set up Abort mode and stack */
+    mrs r0, cpsr
+    bic r0, r0, #0x1F
+    orr r0, r0, #0x17        /* Abort mode (0b10111) */
+    msr cpsr_c, r0
+
+    ldr sp, =_abt_stack_top
+
     /* Set up System mode and main stack */
     mrs r0, cpsr
     bic r0, r0, #0x1F
@@ -59,6 +69,9 @@ zero_bss:
 
     ldr sp, =_kernel_stack_top      /* Regular task stack */
 
+    mov r0, r4
+    bl mem_init             /* Size RAM and the page pools */
+
     ldr r0, =l1_page_table
     bl init_page_table
     
@@ -76,12 +89,12 @@ zero_bss:
     // Set Domain Access Control Register
     /* 
     Domain 0: Kernel domain, check permissions
-    Domain 1: User domain, do not check permissions
+    Domain 1: User domain, check permissions (needed for copy-on-write faults)
     Domain 2: Hardware, check permissions
     Domain 3: Mixed kernel and user, check permissions
-    Domains[5-15]: No access
+    Domains[4-15]: No access
     */
-    mov r1, #0xFFFFFFFF
+    mov r1, #0x55               @ Client (0b01) for domains 0-3
     mcr  p15, 0, r1, c3, c0, 0  @ Write to DACR
 
 
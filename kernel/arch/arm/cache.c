@@ -0,0 +1,72 @@
+#include <kernel/arch/arm/cache.h>
+
+#define LINE_START(addr, size) ((addr) & ~((uintptr_t)(size) - 1))
+
+void dcache_clean_range(uintptr_t start, size_t n)
+{
+    if (!n)
+        return;
+
+    for (uintptr_t line = LINE_START(start, DCACHE_LINE_SIZE); line < start + n; line += DCACHE_LINE_SIZE)
+        asm volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(line) : "memory"); // Clean D line by MVA
+
+    cache_drain_write_buffer();
+}
+
+void dcache_invalidate_range(uintptr_t start, size_t n)
+{
+    if (!n)
+        return;
+
+    uintptr_t end = start + n;
+
+    // Lines shared with data outside the range keep their dirty bytes
+    if (start & (DCACHE_LINE_SIZE - 1))
+        asm volatile("mcr p15, 0, %0, c7, c14, 1" : : "r"(LINE_START(start, DCACHE_LINE_SIZE)) : "memory");
+    if (end & (DCACHE_LINE_SIZE - 1))
+        asm volatile("mcr p15, 0, %0, c7, c14, 1" : : "r"(LINE_START(end, DCACHE_LINE_SIZE)) : "memory");
+
+    for (uintptr_t line = LINE_START(start, DCACHE_LINE_SIZE); line < end; line += DCACHE_LINE_SIZE)
+        asm volatile("mcr p15, 0, %0, c7, c6, 1" : : "r"(line) : "memory"); // Invalidate D line by MVA
+
+    cache_drain_write_buffer();
+}
+
+void dcache_flush_range(uintptr_t start, size_t n)
+{
+    if (!n)
+        return;
+
+    for (uintptr_t line = LINE_START(start, DCACHE_LINE_SIZE); line < start + n; line += DCACHE_LINE_SIZE)
+        asm volatile("mcr p15, 0, %0, c7, c14, 1" : : "r"(line) : "memory"); // Clean and invalidate D line by MVA
+
+    cache_drain_write_buffer();
+}
+
+void dcache_flush_all(void)
+{
+    // Test, clean and invalidate: repeats until no dirty line is left
+    asm volatile("1: mrc p15, 0, r15, c7, c14, 3\n"
+                 "   bne 1b\n"
+                 :
+                 :
+                 : "cc", "memory");
+
+    asm volatile("mcr p15, 0, %0, c7, c6, 0" : : "r"(0) : "memory"); // Invalidate the whole D-cache
+    cache_drain_write_buffer();
+}
+
+void icache_invalidate_range(uintptr_t start, size_t n)
+{
+    if (!n)
+        return;
+
+    for (uintptr_t line = LINE_START(start, ICACHE_LINE_SIZE); line < start + n; line += ICACHE_LINE_SIZE)
+        asm volatile("mcr p15, 0, %0, c7, c5, 1" : : "r"(line) : "memory"); // Invalidate I line by MVA
+}
+
+void cache_sync_code(uintptr_t kva, uintptr_t va, size_t n)
+{
+    dcache_clean_range(kva, n);
+    icache_invalidate_range(va, n);
+}
@@ -1,40 +1,164 @@
 #include <stdint.h>
 #include <kernel/arch/arm/interrupt.h>
+#include <kernel/arch/arm/softirq.h>
 #include <kernel/hw/pic.h>
 #include <kernel/drivers/uart.h>
 #include <kernel/hw/timer.h>
 #include <kernel/core/task/task.h>
+#include <kernel/core/task/ring.h>
+#include <kernel/core/task/kdata.h>
 
-void irq_handler_c(void)
+#define UART_RX_BUFFER_SIZE 64 // Power of two
+
+static uint32_t irq_nesting = 0;         // Number of IRQ frames on the IRQ stack
+static struct PCB *irq_task = NULL;      // Task interrupted by the outermost IRQ
+static bool irq_switchable = false;      // Whether the outermost IRQ may switch tasks
+static uint32_t irq_sources_enabled = 0; // PIC sources enabled by the kernel
+
+// Console input, filled by the top half and drained by the bottom half
+static char uart_rx_buffer[UART_RX_BUFFER_SIZE];
+static volatile uint32_t uart_rx_head = 0;
+static volatile uint32_t uart_rx_tail = 0;
+
+static void uart_bottom_half(void)
+{
+    while (uart_rx_tail != uart_rx_head)
+    {
+        char c = uart_rx_buffer[uart_rx_tail & (UART_RX_BUFFER_SIZE - 1)];
+        uart_rx_tail++;
+
+        uart_putc(uart0, c);
+        uart_putc(uart0, '\n');
+    }
+}
+
+// Raised by task_yield()
+static void soft_bottom_half(void)
+{
+    if (irq_can_switch())
+        scheduler();
+}
+
+// Point the stack of a privileged mode back at its top
+static void reset_mode_stack(uint32_t mode, uintptr_t top)
+{
+    asm volatile(
+        "mrs r12, cpsr\n\t"
+        "msr cpsr_c, %0\n\t"
+        "mov sp, %1\n\t"
+        "msr cpsr_c, r12\n\t"
+        :
+        : "r"(mode | 0xC0), "r"(top)
+        : "r12", "memory");
+}
+
+static void timer_bottom_half(void)
+{
+    kdata_tick();
+
+    // Only a tick that interrupted a user task may do work on its behalf
+    ring_tick(irq_can_switch() && current && !current->kernel && current->state == RUNNING);
+
+    if (irq_can_switch())
+        scheduler();
+}
+
+void irq_enable_sources(uint32_t mask)
+{
+    irq_sources_enabled |= mask;
+    pic->IRQ_ENABLESET = mask;
+}
+
+void irq_disable_sources(uint32_t mask)
+{
+    irq_sources_enabled &= ~mask;
+    pic->IRQ_ENABLECLR = mask;
+}
+
+uint32_t irq_enabled_sources(void)
+{
+    return irq_sources_enabled;
+}
+
+bool irq_can_switch(void)
+{
+    return irq_switchable;
+}
+
+bool irq_in_progress(void)
+{
+    return irq_nesting != 0;
+}
+
+void irq_init(uint32_t sources)
+{
+    softirq_register(SOFTIRQ_UART, uart_bottom_half, PIC_UARTINT0 | PIC_SOFTINT | PIC_TIMERINT1);
+    softirq_register(SOFTIRQ_SOFT, soft_bottom_half, PIC_SOFTINT | PIC_TIMERINT1);
+    softirq_register(SOFTIRQ_TIMER, timer_bottom_half, PIC_TIMERINT1);
+
+    irq_enable_sources(sources);
+}
+
+uint32_t irq_enter(uint32_t *frame)
 {
+    if (irq_nesting++ == 0)
+    {
+        uint32_t mode = frame[CTX_SPSR] & 0x1F;
+
+        irq_task = current;
+        irq_switchable = mode == 0x10 || mode == 0x1F || !current || current->state == TERMINATED;
+    }
+
     uint32_t pic_status = pic->IRQ_STATUS;
 
     if (pic_status & PIC_UARTINT0)
     {
-        // UART0 IRQ
-        uint32_t uart_mis = uart0->mis;
-        if (uart_mis & UART_MIS_RXMIS)
+        // Drain the RX FIFO, dropping characters the bottom half has no room for
+        while (!(uart0->fr & UART_FR_RXFE))
         {
             char c = uart0->dr;
-            uart_putc(uart0, c);
-            uart_putc(uart0, '\n');
+            if (uart_rx_head - uart_rx_tail < UART_RX_BUFFER_SIZE)
+                uart_rx_buffer[uart_rx_head++ & (UART_RX_BUFFER_SIZE - 1)] = c;
         }
         uart0->icr = 0x03FF;
+        softirq_raise(SOFTIRQ_UART);
     }
 
     if (pic_status & PIC_TIMERINT1)
     {
-        uart_puts(uart0, "Timer interrupt\n");
-        // Timer IRQ
         timer1->intclr = 0x1;
-
-        scheduler();
+        softirq_raise(SOFTIRQ_TIMER);
     }
 
     if (pic_status & PIC_SOFTINT)
     {
-        uart_puts(uart0, "Software Interrupt\n");
+        pic->INT_SOFTCLR = PIC_SOFTINT;
+        softirq_raise(SOFTIRQ_SOFT);
+    }
+
+    return softirq_runnable();
+}
+
+void irq_exit(uint32_t *frame)
+{
+    if (--irq_nesting != 0)
+        return; // Nested IRQs return to the interrupted bottom half
+
+    struct PCB *prev = irq_task;
+    irq_task = NULL;
+
+    if (current == prev)
+        return;
+
+    if (prev && prev->state != TERMINATED)
+        memcpy(prev->context, frame, sizeof(prev->context));
+
+    // A task that exited from a syscall or an abort left its frames on these stacks
+    if (prev && prev->state == TERMINATED)
+    {
+        reset_mode_stack(0x13, (uintptr_t)&_svc_stack_top);
+        reset_mode_stack(0x17, (uintptr_t)&_abt_stack_top);
     }
 
-    // IRQs will be re-enabled after we restore context and return
-}
\ No newline at end of file
+    memcpy(frame, current->context, sizeof(current->context));
+}
@@ -0,0 +1,91 @@
+#include <kernel/arch/arm/mem.h>
+#include <kernel/arch/arm/mmu.h>
+#include <kernel/lib/printk.h>
+
+mem_layout_t mem_layout;
+
+// Returns the size of the bank at address 0 from an ATAG list, or 0 without a valid list
+static size_t atag_ram_size(uintptr_t atags)
+{
+    // Boot loaders put the list in the first page of RAM, below the kernel
+    if (!atags || (atags & 3) || atags >= (uintptr_t)&_text_start)
+        return 0;
+
+    atag_header_t *header = (atag_header_t *)atags;
+    if (header->tag != ATAG_CORE)
+        return 0;
+
+    for (uint8_t i = 0; i < ATAG_MAX_TAGS && header->size >= 2 && header->tag != ATAG_NONE; i++)
+    {
+        if (header->tag == ATAG_MEM)
+        {
+            atag_mem_t *bank = (atag_mem_t *)(header + 1);
+            if (bank->start == 0)
+                return bank->size;
+        }
+
+        header = (atag_header_t *)((uint32_t *)header + header->size);
+    }
+
+    return 0;
+}
+
+// Returns the size of the SDRAM module reported by the core module, or 0 if the registers do not look like one
+static size_t cm_ram_size(void)
+{
+    if (CM_ID_MANUFACTURER(cm->ID) != CM_ID_ARM)
+        return 0;
+
+    uint32_t sdram = cm->SDRAM;
+    if (CM_SDRAM_SIZE_FIELD(sdram) > CM_SDRAM_SIZE_MAX)
+        return 0;
+
+    return CM_SDRAM_SIZE(sdram);
+}
+
+void mem_init(uintptr_t atags)
+{
+    size_t ram_size = atag_ram_size(atags);
+    mem_layout.source = MEM_SOURCE_ATAG;
+
+    if (!ram_size)
+    {
+        ram_size = cm_ram_size();
+        mem_layout.source = MEM_SOURCE_CM;
+    }
+
+    if (!ram_size)
+    {
+        ram_size = MEM_DEFAULT_SIZE;
+        mem_layout.source = MEM_SOURCE_DEFAULT;
+    }
+
+    if (ram_size > MEM_MAX_SIZE)
+        ram_size = MEM_MAX_SIZE;
+
+    mem_layout.ram_size = ram_size;
+    mem_layout.kernel_end = MEM_ALIGN_SECTION((uintptr_t)&_kernel_end);
+
+    // Coarse tables grow with the memory tasks can map, L1 tables with the number of tasks
+    size_t free_mb = ram_size > mem_layout.kernel_end ? (ram_size - mem_layout.kernel_end) / SECTION_SIZE : 0;
+    size_t coarse_mb = (free_mb + MEM_COARSE_POOL_RATIO - 1) / MEM_COARSE_POOL_RATIO;
+
+    mem_layout.coarse_start = mem_layout.kernel_end;
+    mem_layout.coarse_size = (coarse_mb ? coarse_mb : 1) * SECTION_SIZE;
+
+    mem_layout.l1_start = mem_layout.coarse_start + mem_layout.coarse_size;
+    mem_layout.l1_size = MEM_L1_POOL_SIZE;
+
+    mem_layout.pages_start = mem_layout.l1_start + mem_layout.l1_size;
+    mem_layout.pages_size = ram_size > mem_layout.pages_start ? ram_size - mem_layout.pages_start : 0;
+}
+
+void mem_print(void)
+{
+    static const char *sources[] = {"default", "boot tags", "core module"};
+
+    printk("RAM: %u MB (%s)\n", mem_layout.ram_size / SECTION_SIZE, sources[mem_layout.source]);
+    printk("  coarse tables: %p, %u KB\n", mem_layout.coarse_start, mem_layout.coarse_size / 1024);
+    printk("  L1 tables:     %p, %u KB\n", mem_layout.l1_start, mem_layout.l1_size / 1024);
+    printk("  pages:         %p, %u KB\n", mem_layout.pages_start, mem_layout.pages_size / 1024);
+}
@@ -2,43 +2,16 @@
 
 void init_page_table(uint32_t *l1)
 {
-    uint32_t free_pages_start = (uint32_t)&_free_pages_start;
-    uint32_t coarse_page_tables_start = (uint32_t)&_coarsepagetables_space_start;
-    uint32_t l1_page_tables_start = (uint32_t)&_l1pagetables_space_start;
-
     // Zero out l1 page table
     memset((void *)l1, 0, NUM_L1_ENTRIES * sizeof(uint32_t));
 
-    // Create section for first 1MB of memory
-    l1[0] = SECTION_ENTRY(0, AP_USER_NONE, DOMAIN_KERNEL);
-
-    // Create sections for coarse page table allocator
-    for (uint8_t i = 0; i < COARSE_TABLE_ALLOCATOR_SPACE_SIZE / SECTION_SIZE; i++)
-    {
-        uintptr_t addr = coarse_page_tables_start + i * SECTION_SIZE;
+    // Create sections for the kernel image, stacks and heap
+    for (uintptr_t addr = 0; addr < mem_layout.kernel_end; addr += SECTION_SIZE)
         l1[L1_INDEX(addr)] = SECTION_ENTRY(addr, AP_USER_NONE, DOMAIN_KERNEL);
-    }
 
-    // Create sections for small page allocator
-    for (uint8_t i = 0; i < PAGE_ALLOCATOR_SPACE_SIZE / SECTION_SIZE; i++)
-    {
-        uintptr_t addr = free_pages_start + i * SECTION_SIZE;
+    // Create sections for the coarse table, L1 table and small page allocators, which follow the kernel up to the end of RAM
+    for (uintptr_t addr = mem_layout.coarse_start; addr < mem_layout.ram_size; addr += SECTION_SIZE)
         l1[L1_INDEX(addr)] = SECTION_ENTRY(addr, AP_USER_NONE, DOMAIN_KERNEL);
-    }
-
-    // Create sections for coarse page table allocator
-    for (uint8_t i = 0; i < COARSE_TABLE_ALLOCATOR_SPACE_SIZE / SECTION_SIZE; i++)
-    {
-        uintptr_t addr = coarse_page_tables_start + i * SECTION_SIZE;
-        l1[L1_INDEX(addr)] = SECTION_ENTRY(addr, AP_USER_NONE, DOMAIN_KERNEL);
-    }
-
-    // Create sections for l1 page table allocator
-    for (uint8_t i = 0; i < L1_TABLE_ALLOCATOR_SPACE_SIZE / SECTION_SIZE; i++)
-    {
-        uintptr_t addr = l1_page_tables_start + i * SECTION_SIZE;
-        l1[L1_INDEX(addr)] = SECTION_ENTRY(addr, AP_USER_NONE, DOMAIN_KERNEL);
-    }
 
     // Create sections for hardware
     l1[L1_INDEX(UART0_BASE)] = SECTION_ENTRY(UART0_BASE, AP_USER_NONE, DOMAIN_HW);
@@ -80,3 +53,63 @@ void set_l1_entry(uintptr_t va, uint32_t entry)
 {
     l1_page_table[L1_INDEX(va)] = entry;
 }
+
+uint32_t *get_coarse_table(uint32_t *l1, uintptr_t va, uint8_t domain)
+{
+    uint32_t l1_entry = l1[L1_INDEX(va)];
+
+    if (is_valid_l1_coarse_entry(l1_entry))
+        return (uint32_t *)COARSE_BASE(l1_entry);
+
+    if (is_valid_l1_section_entry(l1_entry))
+        return NULL; // Never split a section
+
+    uint32_t *coarse_pt = (uint32_t *)alloc_page(ALLOC_1K);
+    if (!coarse_pt)
+        return NULL;
+
+    memset(coarse_pt, 0, TINY_PAGE_SIZE);
+    l1[L1_INDEX(va)] = COARSE_ENTRY((uintptr_t)coarse_pt, domain);
+
+    return coarse_pt;
+}
+
+int8_t split_page_mapping(uint32_t *l1, uintptr_t va)
+{
+    uint32_t l1_entry = l1[L1_INDEX(va)];
+
+    if (is_user_section_entry(l1_entry))
+    {
+        uint32_t *coarse_pt = (uint32_t *)alloc_page(ALLOC_1K);
+        if (!coarse_pt)
+            return -1;
+
+        uintptr_t base = l1_entry & SECTION_MASK;
+        uint8_t ap = SECTION_GET_AP(l1_entry);
+        uint8_t c = (l1_entry >> 3) & 1;
+        uint8_t b = (l1_entry >> 2) & 1;
+        for (size_t i = 0; i < NUM_COARSE_ENTRIES; i++)
+            coarse_pt[i] = L2_PAGE_ENTRY(base + i * SMALL_PAGE_SIZE, AP(ap), c, b);
+
+        l1[L1_INDEX(va)] = COARSE_ENTRY((uintptr_t)coarse_pt, DOMAIN_USER);
+        tlb_invalidate_va(va);
+        return 0;
+    }
+
+    if (!is_valid_l1_coarse_entry(l1_entry))
+        return 0;
+
+    uint32_t *coarse_pt = (uint32_t *)COARSE_BASE(l1_entry);
+    uint32_t entry = coarse_pt[L2_INDEX(va)];
+    if (!is_valid_l2_large_entry(entry))
+        return 0;
+
+    // The 16 copies of the entry become 16 consecutive small pages
+    size_t first = L2_INDEX(va) & ~(LARGE_PAGE_ENTRIES - 1);
+    uintptr_t base = entry & LARGE_PAGE_MASK;
+    for (size_t i = 0; i < LARGE_PAGE_ENTRIES; i++)
+        coarse_pt[first + i] = (entry & ~(LARGE_PAGE_MASK | 0x3)) | (base + i * SMALL_PAGE_SIZE) | L2_TYPE_SMALL;
+
+    tlb_invalidate_va(va);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <kernel/arch/arm/softirq.h>
+#include <kernel/arch/arm/interrupt.h>
+#include <kernel/hw/pic.h>
+
+typedef struct softirq
+{
+    softirq_fn_t fn;
+    uint32_t pic_mask;
+} softirq_t;
+
+static softirq_t softirqs[NR_SOFTIRQS];
+static volatile uint32_t softirq_pending = 0;
+static int8_t softirq_active = -1; // Softirq whose bottom half is running, -1 if none
+static uint32_t pic_blocked = 0;   // PIC sources disabled by running bottom halves
+
+void softirq_register(uint8_t nr, softirq_fn_t fn, uint32_t pic_mask)
+{
+    if (nr >= NR_SOFTIRQS)
+        return;
+
+    softirqs[nr].fn = fn;
+    softirqs[nr].pic_mask = pic_mask;
+}
+
+void softirq_raise(uint8_t nr)
+{
+    if (nr < NR_SOFTIRQS)
+        softirq_pending |= 1u << nr;
+}
+
+// Pending softirqs allowed to preempt the running bottom half
+static uint32_t softirq_preempting(void)
+{
+    if (softirq_active < 0)
+        return softirq_pending;
+
+    return softirq_pending & ((1u << softirq_active) - 1);
+}
+
+bool softirq_in_progress(void)
+{
+    return softirq_active >= 0;
+}
+
+bool softirq_runnable(void)
+{
+    return softirq_preempting() != 0;
+}
+
+void softirq_run(void)
+{
+    int8_t interrupted = softirq_active;
+
+    while (1)
+    {
+        unsigned int flags = irq_save();
+
+        uint32_t runnable = softirq_preempting();
+        if (!runnable)
+        {
+            irq_restore(flags);
+            break;
+        }
+
+        uint8_t nr = 0;
+        while (!(runnable & (1u << nr)))
+            nr++;
+
+        softirq_pending &= ~(1u << nr);
+        softirq_active = nr;
+
+        // Keep this and lower priority sources quiet while the bottom half runs
+        uint32_t blocked = pic_blocked;
+        pic_blocked |= softirqs[nr].pic_mask;
+        pic->IRQ_ENABLECLR = pic_blocked & irq_enabled_sources();
+
+        irq_restore(flags);
+
+        if (softirqs[nr].fn)
+            softirqs[nr].fn();
+
+        flags = irq_save();
+
+        pic_blocked = blocked;
+        pic->IRQ_ENABLESET = irq_enabled_sources() & ~pic_blocked;
+        softirq_active = interrupted;
+
+        irq_restore(flags);
+    }
+}
@@ -1,17 +1,315 @@
 #include <kernel/arch/arm/svc.h>
 
+// r0 = SCHED_INFO_TASK or SCHED_INFO_LATENCY, r1 = task index, r2 = user buffer
+static int32_t sys_sched_info(regs_t *regs)
+{
+    uint32_t which = regs->r0;
+    uint32_t index = regs->r1;
+    void *buf = (void *)regs->r2;
+
+    if (which == SCHED_INFO_TASK)
+    {
+        sched_task_info_t info;
+        if (sched_task_info(index, &info) < 0)
+            return -1;
+        return copy_to_user(buf, &info, sizeof(info));
+    }
+
+    if (which == SCHED_INFO_LATENCY)
+    {
+        sched_latency_info_t info;
+        sched_latency_info(&info);
+        return copy_to_user(buf, &info, sizeof(info));
+    }
+
+    return -1;
+}
+
+static int32_t sys_exit(regs_t *regs)
+{
+    task_exit(regs->r0); // noreturn
+}
+
+static int32_t sys_printf(regs_t *regs)
+{
+    const char *s = (const char *)regs->r0;
+
+    // Print a page worth at a time so a bad pointer fails the call instead of aborting in the driver
+    int32_t len;
+    while ((len = strnlen_user(s, SMALL_PAGE_SIZE)) == SMALL_PAGE_SIZE)
+    {
+        uart_write(uart0, s, len);
+        s += len;
+    }
+
+    if (len < 0)
+        return -1;
+
+    uart_write(uart0, s, len);
+    return 0;
+}
+
+static int32_t sys_read(regs_t *regs)
+{
+    return file_read_wait(regs);
+}
+
+static int32_t sys_fork(regs_t *regs)
+{
+    return task_fork(regs);
+}
+
+static int32_t sys_yield(regs_t *regs)
+{
+    (void)regs;
+    sched_yield();
+    return 0;
+}
+
+static int32_t sys_wait(regs_t *regs)
+{
+    return task_wait(regs);
+}
+
+static int32_t sys_clone(regs_t *regs)
+{
+    return task_clone(regs);
+}
+
+static int32_t sys_sched_setrt(regs_t *regs)
+{
+    return sched_set_rt(current, regs->r0, regs->r1, regs->r2);
+}
+
+static int32_t sys_open(regs_t *regs)
+{
+    return file_open((const char *)regs->r0, regs->r1);
+}
+
+static int32_t sys_write(regs_t *regs)
+{
+    return file_write_wait(regs);
+}
+
+static int32_t sys_lseek(regs_t *regs)
+{
+    return file_lseek(regs->r0, regs->r1, regs->r2);
+}
+
+static int32_t sys_close(regs_t *regs)
+{
+    return file_close(regs->r0);
+}
+
+static int32_t sys_stat(regs_t *regs)
+{
+    return file_stat((const char *)regs->r0, (stat_t *)regs->r1);
+}
+
+static int32_t sys_shm_attach(regs_t *regs)
+{
+    return shm_attach((const char *)regs->r0, regs->r1);
+}
+
+static int32_t sys_shm_detach(regs_t *regs)
+{
+    return shm_detach(regs->r0);
+}
+
+static int32_t sys_futex_wait(regs_t *regs)
+{
+    return futex_wait((uint32_t *)regs->r0, regs->r1);
+}
+
+static int32_t sys_futex_wake(regs_t *regs)
+{
+    return futex_wake((uint32_t *)regs->r0, regs->r1);
+}
+
+static int32_t sys_port_create(regs_t *regs)
+{
+    (void)regs;
+    return ipc_port_create();
+}
+
+static int32_t sys_port_destroy(regs_t *regs)
+{
+    return ipc_port_destroy(regs->r0);
+}
+
+static int32_t sys_port_send(regs_t *regs)
+{
+    return ipc_send(regs->r0, (const ipc_msg_t *)regs->r1, regs->r2);
+}
+
+static int32_t sys_port_recv(regs_t *regs)
+{
+    return ipc_receive(regs);
+}
+
+static int32_t sys_ring_setup(regs_t *regs)
+{
+    (void)regs;
+    return ring_setup();
+}
+
+static int32_t sys_enter(regs_t *regs)
+{
+    return ring_enter(regs);
+}
+
+static int32_t sys_pipe(regs_t *regs)
+{
+    return file_pipe((int32_t *)regs->r0, regs->r1, regs->r2);
+}
+
+static int32_t sys_mmap(regs_t *regs)
+{
+    return mmap_map(regs->r0, regs->r1, regs->r2, regs->r3);
+}
+
+static int32_t sys_munmap(regs_t *regs)
+{
+    return mmap_unmap(regs->r0);
+}
+
+static int32_t sys_msync(regs_t *regs)
+{
+    return mmap_sync(regs->r0, regs->r1);
+}
+
+// r0 = SYSCALL_STATS_GET with r1 = user buffer, or SYSCALL_STATS_RESET
+static int32_t sys_syscall_stats(regs_t *regs)
+{
+    if (regs->r0 == SYSCALL_STATS_GET)
+    {
+        syscall_stats_t stats;
+        syscall_stats_get(&stats);
+        return copy_to_user((void *)regs->r1, &stats, sizeof(stats));
+    }
+
+    if (regs->r0 == SYSCALL_STATS_RESET)
+    {
+        syscall_stats_reset();
+        return 0;
+    }
+
+    return -1;
+}
+
+static const syscall_fn_t syscall_table[NR_SYSCALLS] = {
+    [SYS_EXIT] = sys_exit,
+    [SYS_PRINTF] = sys_printf,
+    [SYS_READ] = sys_read,
+    [SYS_FORK] = sys_fork,
+    [SYS_SCHED_INFO] = sys_sched_info,
+    [SYS_YIELD] = sys_yield,
+    [SYS_WAIT] = sys_wait,
+    [SYS_CLONE] = sys_clone,
+    [SYS_SCHED_SETRT] = sys_sched_setrt,
+    [SYS_OPEN] = sys_open,
+    [SYS_WRITE] = sys_write,
+    [SYS_LSEEK] = sys_lseek,
+    [SYS_CLOSE] = sys_close,
+    [SYS_STAT] = sys_stat,
+    [SYS_SHM_ATTACH] = sys_shm_attach,
+    [SYS_SHM_DETACH] = sys_shm_detach,
+    [SYS_FUTEX_WAIT] = sys_futex_wait,
+    [SYS_FUTEX_WAKE] = sys_futex_wake,
+    [SYS_PORT_CREATE] = sys_port_create,
+    [SYS_PORT_DESTROY] = sys_port_destroy,
+    [SYS_PORT_SEND] = sys_port_send,
+    [SYS_PORT_RECV] = sys_port_recv,
+    [SYS_RING_SETUP] = sys_ring_setup,
+    [SYS_ENTER] = sys_enter,
+    [SYS_PIPE] = sys_pipe,
+    [SYS_MMAP] = sys_mmap,
+    [SYS_MUNMAP] = sys_munmap,
+    [SYS_MSYNC] = sys_msync,
+    [SYS_SYSCALL_STATS] = sys_syscall_stats,
+};
+
+static const char *const syscall_names[NR_SYSCALLS] = {
+    [SYS_EXIT] = "exit",
+    [SYS_PRINTF] = "printf",
+    [SYS_READ] = "read",
+    [SYS_FORK] = "fork",
+    [SYS_SCHED_INFO] = "sched_info",
+    [SYS_YIELD] = "yield",
+    [SYS_WAIT] = "wait",
+    [SYS_CLONE] = "clone",
+    [SYS_SCHED_SETRT] = "sched_setrt",
+    [SYS_OPEN] = "open",
+    [SYS_WRITE] = "write",
+    [SYS_LSEEK] = "lseek",
+    [SYS_CLOSE] = "close",
+    [SYS_STAT] = "stat",
+    [SYS_SHM_ATTACH] = "shm_attach",
+    [SYS_SHM_DETACH] = "shm_detach",
+    [SYS_FUTEX_WAIT] = "futex_wait",
+    [SYS_FUTEX_WAKE] = "futex_wake",
+    [SYS_PORT_CREATE] = "port_create",
+    [SYS_PORT_DESTROY] = "port_destroy",
+    [SYS_PORT_SEND] = "port_send",
+    [SYS_PORT_RECV] = "port_recv",
+    [SYS_RING_SETUP] = "ring_setup",
+    [SYS_ENTER] = "enter",
+    [SYS_PIPE] = "pipe",
+    [SYS_MMAP] = "mmap",
+    [SYS_MUNMAP] = "munmap",
+    [SYS_MSYNC] = "msync",
+    [SYS_SYSCALL_STATS] = "syscall_stats",
+};
+
+_Static_assert(NR_SYSCALLS <= SYSCALL_STATS_MAX, "syscall_stats_t is too small for every syscall");
+
+static syscall_stats_t stats; // Counted since stats.since_us
+
+static inline void syscall_account(syscall_stat_t *stat, uint32_t us)
+{
+    stat->total_us += us;
+    if (us > stat->max_us)
+        stat->max_us = us;
+}
+
+void syscall_stats_get(syscall_stats_t *out)
+{
+    memcpy(out, &stats, sizeof(syscall_stats_t));
+}
+
+void syscall_stats_reset(void)
+{
+    memset(&stats, 0, sizeof(syscall_stats_t));
+    stats.since_us = clock_us();
+    sched_reset_syscall_stats();
+}
+
+const char *syscall_name(uint32_t nr)
+{
+    return nr < NR_SYSCALLS ? syscall_names[nr] : NULL;
+}
+
 void svc_handler_c(regs_t *regs)
 {
-    switch (regs->r7)
+    uint32_t nr = regs->r7;
+
+    if (nr >= NR_SYSCALLS || !syscall_table[nr])
     {
-    case SYS_PRINTF:
-        uart_puts(uart0, (const char *)regs->r0);
-        break;
-    case SYS_EXIT:
-        task_exit(regs->r0); // noreturn
-        break;
-    default:
-        regs->r0 = (uint32_t)-1; // Unknown syscall
-        break;
+        regs->r0 = -1; // Unknown syscall
+        return;
     }
-}
\ No newline at end of file
+
+    // Counted up front, so calls that never return (exit) are too
+    struct PCB *task = current;
+    stats.calls[nr].calls++;
+    if (task)
+        task->syscalls.calls++;
+
+    uint32_t start = clock_counter();
+    regs->r0 = syscall_table[nr](regs);
+    uint32_t us = start - clock_counter(); // The counter counts down
+
+    syscall_account(&stats.calls[nr], us);
+    if (task)
+        syscall_account(&task->syscalls, us);
+}
@@ -12,108 +12,81 @@ _vectors:
     b irq_handler           // IRQ
     b fiq_handler           // FIQ
 
-.extern current
-.extern irq_handler_c
+.extern irq_enter
+.extern irq_exit
+.extern softirq_run
 
 /*
  * ARM Interrupt Request (IRQ) Handler
- * Uses context buffer in PCB structure for reliable context switching
+ *
+ * The top half (irq_enter) runs in IRQ mode with IRQs masked and only acks the
+ * PIC sources. Bottom halves (softirq_run) run in SVC mode with IRQs enabled,
+ * so a higher priority source can interrupt them. The frame of the interrupted
+ * code stays on the IRQ stack in PCB::context layout; irq_exit swaps it for the
+ * next task's context when the scheduler switched tasks.
  */
 
 irq_handler:
     sub     lr, lr, #4          /* Adjust LR_irq to interrupted PC */
-    
-    /* === Save all context to IRQ stack first === */
+    sub     sp, sp, #4          /* Pad the 17 word frame to keep 8-byte alignment */
+
+    /* === Save all context to the IRQ stack === */
     push    {r0-r12, lr}        /* Save all GPRs and adjusted LR */
-    mrs     r0, spsr            
+    mrs     r0, spsr
     push    {r0}                /* Save SPSR_irq */
-    
-    /* Get original mode SP and LR while we can still access them */
+
+    /* Get the banked SP and LR of the interrupted mode (system mode shares user mode's) */
     and     r1, r0, #0x1F       /* r1 = original mode from SPSR */
-    mrs     r2, cpsr            /* r2 = current CPSR (IRQ mode) */
-    bic     r3, r2, #0x1F       /* Clear mode bits */
-    orr     r3, r3, r1          /* Set original mode */
-    msr     cpsr_c, r3          /* Switch to original mode */
-    
+    cmp     r1, #0x10
+    moveq   r1, #0x1F           /* User mode: read them from system mode */
+    orr     r1, r1, #0xC0       /* Keep IRQs/FIQs masked */
+    msr     cpsr_c, r1          /* Switch to original mode */
     mov     r4, sp              /* r4 = original SP */
     mov     r5, lr              /* r5 = original LR */
-    
-    msr     cpsr_c, r2          /* Back to IRQ mode */
+    msr     cpsr_c, #0xD2       /* Back to IRQ mode, IRQs/FIQs masked */
     push    {r4, r5}            /* Save original SP, LR to IRQ stack */
-    
-    /* Disable IRQs/FIQs for critical section */
-    orr     r2, r2, #0xC0
-    msr     cpsr_c, r2
-    
-    /* === Save context to current task's context buffer === */
-    ldr     r6, =current
-    ldr     r7, [r6]            /* r7 = current task */
-    cmp     r7, #0              /* Check if current is NULL */
-    beq     call_scheduler
-    
-    ldr     r8, [r7, #4]        /* r8 = task->state */
-    cmp     r8, #3              /* Check if task is TERMINATED */
-    beq     call_scheduler
-    
-    /* Calculate offset to context buffer in PCB */
-    add     r8, r7, #8         /* r8 = &task->context_buffer */
-    
-    /* Copy entire IRQ stack contents to context buffer */
-    mov     r9, sp              /* r9 = IRQ stack pointer */
-    mov     r10, #17            /* r10 = number of words to copy */
-    
-save_context_loop:
-    ldr     r11, [r9], #4       /* Load from IRQ stack, increment */
-    str     r11, [r8], #4       /* Store to context buffer, increment */
-    subs    r10, r10, #1
-    bne     save_context_loop
-    
-    /* Clear IRQ stack */
-    add     sp, sp, #(17 * 4)
-
-call_scheduler:
-    /* Call C scheduler - this changes current and page tables */
-    bl      irq_handler_c
-    
-    /* === Restore context from new task's context buffer === */
-    ldr     r6, =current
-    ldr     r7, [r6]            /* r7 = new current task */
-    
-    /* Calculate offset to context buffer */
-    add     r8, r7, #8         /* r8 = &task->context_buffer */
-    mov     r9, #17            /* r9 = number of words to copy */
-    
-restore_context_loop:
-    ldr     r11, [r8], #4       /* Load from context buffer, increment */
-    push    {r11}
-    subs    r9, r9, #1
-    bne     restore_context_loop
-    
+
+    /* === Top half === */
+    mov     r0, sp              /* arg0 = frame */
+    bl      irq_enter
+    cmp     r0, #0
+    beq     irq_return
+
+    /* === Bottom halves, in SVC mode so nested IRQs cannot clobber LR_irq === */
+    msr     cpsr_c, #0xD3       /* SVC mode, IRQs/FIQs masked */
+    mov     r4, sp
+    bic     sp, sp, #7          /* AAPCS stack alignment */
+    push    {r4, lr}            /* Preserve SP_svc and LR_svc of the interrupted code */
+    msr     cpsr_c, #0x53       /* Enable IRQs */
+    bl      softirq_run
+    msr     cpsr_c, #0xD3       /* Mask IRQs again */
+    pop     {r4, lr}
+    mov     sp, r4
+    msr     cpsr_c, #0xD2       /* Back to IRQ mode */
+
+irq_return:
+    mov     r0, sp              /* arg0 = frame */
+    bl      irq_exit            /* May replace the frame with another task's context */
+
     /* === Restore processor state === */
-    pop     {r4, r5}            /* r4 = original LR, r5 = original SP */
+    pop     {r4, r5}            /* r4 = original SP, r5 = original LR */
     pop     {r0}                /* r0 = SPSR */
     msr     spsr_cxsf, r0       /* Restore SPSR */
-    
-    /* Switch to System mode to restore SP and LR */
-    /* Cannot switch directly from IRQ to User mode - use System mode instead */
-    mrs     r2, cpsr            /* r2 = current CPSR (IRQ mode) */
-    bic     r3, r2, #0x1F       /* Clear mode bits */
-    orr     r3, r3, #0x1F       /* Set System mode (0b11111) */
-    msr     cpsr_c, r3          /* Switch to System mode */
-    
-    /* Restore original mode SP and LR */
-    mov     lr, r4
-    mov     sp, r5
-    
-    /* Return to IRQ mode for final cleanup */
-    bic     r2, r2, #0xC0       /* Re-enable IRQs/FIQs */
-    msr     cpsr_c, r2          /* Back to IRQ mode */
+
+    and     r1, r0, #0x1F       /* Mode being returned to */
+    cmp     r1, #0x10
+    moveq   r1, #0x1F           /* Cannot switch from IRQ to user mode, use system mode */
+    orr     r1, r1, #0xC0
+    msr     cpsr_c, r1
+    mov     sp, r4              /* Restore original mode SP and LR */
+    mov     lr, r5
+    msr     cpsr_c, #0xD2       /* Back to IRQ mode. IRQs stay masked until the return restores the SPSR */
 
     /* Restore all registers and return */
-    pop     {r0-r12}            /* Restore general purpose registers */
-    pop     {lr}                /* Return to interrupted code */
+    pop     {r0-r12, lr}
+    add     sp, sp, #4          /* Drop the alignment pad */
     subs    pc, lr, #0
-    
+
 
 
 // Default dummy handlers
@@ -121,22 +94,66 @@ undefined_handler: b .
 
 .extern svc_handler_c
 svc_handler:
-    sub sp, sp, #68     // Make space for 17 registers
+    sub sp, sp, #64           // regs_t frame (15 words, padded to keep 8-byte alignment)
     stmia sp, {r0-r12, lr}    // Store r0-r12, lr onto the stack
 
     mrs r0, spsr              // Get spsr into r0
-    str r0, [sp, #64]   // Store spsr at end of frame
+    str r0, [sp, #56]         // regs->spsr
 
     mov r0, sp                // Pass pointer to frame as argument
     bl svc_handler_c          // Call C handler with regs_t*
 
+    ldr r0, [sp, #56]         // Restore spsr first so no GPR is clobbered
+    msr spsr_cxsf, r0         // Write spsr back
     ldmia sp, {r0-r12, lr}    // Restore r0-r12, lr
-    ldr r1, [sp, #64]   // Restore spsr into r1
-    add sp, sp, #68     // Clean up stack
-    msr spsr_cxsf, r1         // Write spsr back
+    add sp, sp, #64           // Clean up stack
     movs pc, lr               // Return from SVC
 
 
-prefetch_abort_handler: b .
-data_abort_handler: b .
+.extern prefetch_abort_handler_c
+/*
+ * ARM Prefetch Abort Handler
+ * Same frame as the data abort handler. The faulting address is the aborted
+ * instruction itself, so only the Instruction Fault Status Register is passed.
+ */
+prefetch_abort_handler:
+    sub     lr, lr, #4              /* LR_abt points 4 bytes past the aborted instruction */
+    sub     sp, sp, #64             /* regs_t frame (15 words, padded to keep 8-byte alignment) */
+    stmia   sp, {r0-r12, lr}        /* Store r0-r12, lr onto the stack */
+
+    mrs     r0, spsr
+    str     r0, [sp, #56]           /* regs->spsr */
+
+    mov     r0, sp                  /* arg0 = regs_t* */
+    mrc     p15, 0, r1, c5, c0, 1   /* arg1 = Instruction Fault Status Register */
+    bl      prefetch_abort_handler_c
+    b       abort_return
+
+.extern data_abort_handler_c
+/*
+ * ARM Data Abort Handler
+ * Builds a regs_t frame on the abort stack and passes the fault address (FAR)
+ * and fault status (FSR) to the C handler. Returning re-executes the aborted
+ * instruction, so the C handler must either fix the mapping or kill the task.
+ */
+data_abort_handler:
+    sub     lr, lr, #8              /* LR_abt points 8 bytes past the aborted instruction */
+    sub     sp, sp, #64             /* regs_t frame (15 words, padded to keep 8-byte alignment) */
+    stmia   sp, {r0-r12, lr}        /* Store r0-r12, lr onto the stack */
+
+    mrs     r0, spsr
+    str     r0, [sp, #56]           /* regs->spsr */
+
+    mov     r0, sp                  /* arg0 = regs_t* */
+    mrc     p15, 0, r1, c6, c0, 0   /* arg1 = Fault Address Register */
+    mrc     p15, 0, r2, c5, c0, 0   /* arg2 = Data Fault Status Register */
+    bl      data_abort_handler_c
+
+abort_return:
+    ldr     r0, [sp, #56]           /* Restore spsr first so no GPR is clobbered */
+    msr     spsr_cxsf, r0
+    ldmia   sp, {r0-r12, lr}        /* Restore r0-r12, lr */
+    add     sp, sp, #64             /* Clean up stack */
+    movs    pc, lr                  /* Retry the aborted instruction */
+
 fiq_handler:       b .
@@ -22,15 +22,18 @@ int kernel_main(void)
 
     uart0_init(115200); // Initialize UART with 115200 baud rate, 2 stop bits, 8 data bits, no parity
     timer1_init(1e6, TIMER_MODE_PERIODIC, TIMER_IE, TIMER_PRESCALE_NONE_gc, TIMER_SIZE_32, 0);
+    clocksource_init();
 
-    pic->IRQ_ENABLESET = PIC_TIMERINT1 | PIC_UARTINT0 | PIC_UARTINT1;
+    irq_init(PIC_TIMERINT1 | PIC_UARTINT0 | PIC_UARTINT1 | PIC_SOFTINT);
 
     kheap_init((uintptr_t)&_kernel_heap_start);
-    init_page_allocator(ALLOC_1K, COARSE_TABLE_ALLOCATOR_SPACE_SIZE / TINY_PAGE_SIZE, TINY_PAGE_SIZE, (uintptr_t)&_coarsepagetables_space_start);
-    init_page_allocator(ALLOC_4K, PAGE_ALLOCATOR_SPACE_SIZE / SMALL_PAGE_SIZE, SMALL_PAGE_SIZE, (uintptr_t)&_free_pages_start);
-    init_page_allocator(ALLOC_16K, L1_TABLE_ALLOCATOR_SPACE_SIZE / L1_TABLE_SIZE, L1_TABLE_SIZE, (uintptr_t)&_l1pagetables_space_start);
+    mem_print();
+    init_page_allocator(ALLOC_1K, mem_layout.coarse_size / TINY_PAGE_SIZE, TINY_PAGE_SIZE, mem_layout.coarse_start);
+    init_page_allocator(ALLOC_4K, mem_layout.pages_size / SMALL_PAGE_SIZE, SMALL_PAGE_SIZE, mem_layout.pages_start);
+    init_page_allocator(ALLOC_16K, mem_layout.l1_size / L1_TABLE_SIZE, L1_TABLE_SIZE, mem_layout.l1_start);
 
     task_init();
+    workqueue_init();
 
     mmci_card_init();
     fat32_init(0);
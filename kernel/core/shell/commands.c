@@ -20,4 +20,100 @@ void ls(const char *path)
     printk("%s", s);
     kfree(s);
     s = NULL;
-}
\ No newline at end of file
+}
+void top(void)
+{
+    static const char *states[] = {"RUN", "READY", "BLOCK", "TERM"};
+
+    sched_latency_info_t latency;
+    sched_latency_info(&latency);
+    uint64_t uptime = latency.uptime_us ? latency.uptime_us : 1;
+
+    printk("uptime %u ms\n", (uint32_t)(latency.uptime_us / 1000));
+    printk("  PID NAME        STATE    CPU%%   RUN(ms)  WAIT(ms) MAXWAIT(us) SWITCHES\n");
+
+    sched_task_info_t info;
+    for (uint32_t i = 0; sched_task_info(i, &info) == 0; i++)
+    {
+        printk("%5u %s%s", info.pid, info.name, info.kernel ? "*" : " ");
+        for (size_t pad = strlen(info.name); pad < 11; pad++)
+            printk(" ");
+        printk("%5s %7u %9u %9u %11u %8u\n",
+               info.state < 4 ? states[info.state] : "?",
+               (uint32_t)(info.runtime_us * 100 / uptime),
+               (uint32_t)(info.runtime_us / 1000),
+               (uint32_t)(info.wait_us / 1000),
+               info.max_wait_us,
+               info.switches);
+    }
+
+    bool header = false;
+    for (uint32_t i = 0; sched_task_info(i, &info) == 0; i++)
+    {
+        if (!info.rt_period_us)
+            continue;
+
+        if (!header)
+        {
+            printk("Real-time tasks\n");
+            printk("  PID PERIOD(us) RUNTIME(us) DEADLINE(us)   MISSES OVERRUNS\n");
+            header = true;
+        }
+
+        printk("%5u %10u %11u %12u %8u %8u\n", info.pid, info.rt_period_us, info.rt_runtime_us,
+               info.rt_deadline_us, info.rt_misses, info.rt_overruns);
+    }
+
+    printk("Wakeup-to-run latency (%u samples)\n", latency.samples);
+    for (size_t i = 0; i < SCHED_LAT_BUCKETS; i++)
+    {
+        if (!latency.buckets[i])
+            continue;
+
+        if (i == SCHED_LAT_BUCKETS - 1)
+            printk("  >= %u us: %u\n", 1u << i, latency.buckets[i]);
+        else
+            printk("  %u-%u us: %u\n", i ? 1u << i : 0, (1u << (i + 1)) - 1, latency.buckets[i]);
+    }
+}
+
+// Prints the syscall counters, then zeroes them if reset is set
+void sysstat(bool reset)
+{
+    syscall_stats_t stats;
+    syscall_stats_get(&stats);
+
+    printk("Syscalls over the last %u ms\n", (uint32_t)((clock_us() - stats.since_us) / 1000));
+    printk("SYSCALL           CALLS  TOTAL(us)  AVG(us)  MAX(us)\n");
+
+    for (uint32_t nr = 0; nr < SYSCALL_STATS_MAX; nr++)
+    {
+        syscall_stat_t *stat = &stats.calls[nr];
+        const char *name = syscall_name(nr);
+        if (!stat->calls || !name)
+            continue;
+
+        printk("%s", name);
+        for (size_t pad = strlen(name); pad < 14; pad++)
+            printk(" ");
+        printk("%9u %10u %8u %8u\n", stat->calls, (uint32_t)stat->total_us,
+               (uint32_t)(stat->total_us / stat->calls), stat->max_us);
+    }
+
+    printk("  PID NAME          CALLS  TOTAL(us)  MAX(us)\n");
+
+    sched_task_info_t info;
+    for (uint32_t i = 0; sched_task_info(i, &info) == 0; i++)
+    {
+        if (!info.syscalls)
+            continue;
+
+        printk("%5u %s", info.pid, info.name);
+        for (size_t pad = strlen(info.name); pad < 11; pad++)
+            printk(" ");
+        printk("%9u %10u %8u\n", info.syscalls, (uint32_t)info.syscall_us, info.syscall_max_us);
+    }
+
+    if (reset)
+        syscall_stats_reset();
+}
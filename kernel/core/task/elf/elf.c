@@ -3,7 +3,15 @@
 uintptr_t elf_load(const char *path, struct PCB *task)
 {
     printk("elf_load\n");
-    uintptr_t entry;
-    elf_load_internal(path, task, false, &entry, NULL);
+
+    // A cached image only costs page table setup
+    uintptr_t entry = image_cache_attach(path, task);
+    if (entry)
+        return entry;
+
+    if (elf_load_internal(path, task, false, &entry, NULL) < 0)
+        return 0;
+
+    image_cache_insert(path, task, entry);
     return entry;
 }
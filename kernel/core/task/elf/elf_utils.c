@@ -85,7 +85,8 @@ static int8_t elf_vm_alloc(uint32_t *l1, size_t n, uintptr_t va, page_info_t *pa
         if (pages)
         {
             pages[i].page_phys = page_phys;
-            pages[i].offset = elf_mem - curr_va;
+            pages[i].offset = curr_va - elf_mem;
+            page_get(ALLOC_4K, (void *)page_phys); // Held by the shared object itself
         }
 
         coarse_table[l2_idx] = L2_PAGE_ENTRY(page_phys, AP(AP_USER_RW), C_WB, B_BUF);
@@ -127,6 +128,7 @@ static int8_t read_into_va_space(int8_t fd, Elf32_Word filesz, Elf32_Off offset,
 
         /* write into the page at the proper offset */
         memcpy((void *)(phys_page + page_offset), buf, to_read);
+        cache_sync_code(phys_page + page_offset, curr_va, to_read);
 
         curr_va += to_read;
         remaining -= to_read;
@@ -146,6 +148,18 @@ int8_t parse_pt_load(int8_t fd, uintptr_t va, uint32_t *l1, Elf32_Phdr *phdr, pa
     return 0;
 }
 
+// Records a loadable segment of an executable as a demand-paged region.
+// Nothing is allocated or read until the task touches the segment.
+static int8_t elf_add_region(struct PCB *task, int8_t fd, Elf32_Phdr *phdr, uintptr_t va)
+{
+    uint8_t ap = (phdr->p_flags & PF_W) ? AP_USER_RW : AP_USER_READ;
+
+    if (!vm_region_add(task, va, phdr->p_memsz, ap, fd, phdr->p_offset, phdr->p_filesz))
+        return -1;
+
+    return 0;
+}
+
 /*
 * FIELDS SET IN TASK
     - fd
@@ -211,9 +225,15 @@ int8_t elf_load_internal(
     if (is_shared_object)
     {
         so_opt->fd = fd;
-        so_opt->num_pages = (size_t)math_ceil(total_size / SMALL_PAGE_SIZE);
+        so_opt->num_pages = (total_size + SMALL_PAGE_SIZE - 1) / SMALL_PAGE_SIZE;
         so_opt->pages = kmalloc(so_opt->num_pages * sizeof(page_info_t));
+        if (!so_opt->pages)
+            return -1;
+        memset(so_opt->pages, 0, so_opt->num_pages * sizeof(page_info_t));
         task->elf_info.next_so_base += total_size;
+
+        if (!vm_region_insert(task, so_base, so_base + so_opt->num_pages * SMALL_PAGE_SIZE, AP_USER_RW, VM_REGION_SO))
+            return -1;
     }
     else
     {
@@ -239,9 +259,17 @@ int8_t elf_load_internal(
         {
         case PT_PHDR:
         case PT_LOAD:
+            if (!is_shared_object)
+            {
+                if (elf_add_region(task, fd, &phdr, vaddr) < 0)
+                    return -1;
+                break;
+            }
+
+            // Shared objects are loaded eagerly: their pages are shared by every task
             if (parse_pt_load(fd, vaddr, task->pt, &phdr, pages, elf_mem) < 0)
                 return -1;
-            pages += (size_t)math_ceil(phdr.p_memsz / SMALL_PAGE_SIZE);
+            pages += (phdr.p_memsz + SMALL_PAGE_SIZE - 1) / SMALL_PAGE_SIZE;
             break;
 
         case PT_DYNAMIC:
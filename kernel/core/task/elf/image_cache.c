@@ -0,0 +1,275 @@
+#include <kernel/core/task/elf/image_cache.h>
+
+static image_t *image_list = NULL; // Most recently used first
+static size_t num_images = 0;
+static slab_cache_t *image_cache = NULL;
+
+static void image_free(image_t *image)
+{
+    for (size_t i = 0; image->pages && i < image->num_pages; i++)
+    {
+        if (image->pages[i])
+            page_put(ALLOC_4K, (void *)image->pages[i]);
+    }
+
+    kfree(image->pages);
+    vm_region_free_list(&image->regions);
+    release_shared_object_list(&image->shared_objs);
+    slab_free(image_cache, image);
+}
+
+// Removes an image from the cache. It is freed once no task runs it anymore
+static void image_evict(image_t *image)
+{
+    image_t **p = &image_list;
+    while (*p && *p != image)
+        p = &(*p)->next;
+
+    if (*p)
+    {
+        *p = image->next;
+        num_images--;
+    }
+
+    image->stale = true;
+    if (image->ref_count == 0)
+        image_free(image);
+}
+
+void image_cache_invalidate(uint32_t first_cluster)
+{
+    for (image_t *image = image_list, *next; image; image = next)
+    {
+        next = image->next;
+        if (image->first_cluster == first_cluster)
+            image_evict(image);
+    }
+}
+
+static image_t *image_find(const char *path)
+{
+    for (image_t *image = image_list; image; image = image->next)
+    {
+        if (strcmp(image->path, path) == 0)
+            return image;
+    }
+
+    return NULL;
+}
+
+static bool image_matches(image_t *image, fat32_dir_entry_t *entry)
+{
+    uint32_t first_cluster = ((uint32_t)entry->first_cluster_high << 16) | entry->first_cluster_low;
+
+    return image->first_cluster == first_cluster &&
+           image->file_size == entry->file_size &&
+           image->modify_date == entry->modify_date &&
+           image->modify_time == entry->modify_time;
+}
+
+uintptr_t image_cache_attach(const char *path, struct PCB *task)
+{
+    image_t *image = image_find(path);
+    if (!image)
+        return 0;
+
+    fat32_dir_entry_t entry;
+    if (fat32_stat(path, &entry) || !image_matches(image, &entry))
+    {
+        printk("Cached image of %s is stale\n", path);
+        image_evict(image);
+        return 0;
+    }
+
+    int8_t fd = fat32_open(path);
+    if (fd < 0)
+        return 0;
+
+    if (vm_region_copy_list(&task->regions, image->regions, VM_REGION_SEGMENT) < 0 ||
+        attach_shared_objects(task, image->shared_objs) < 0)
+    {
+        vm_region_remove_all(task, VM_REGION_SEGMENT | VM_REGION_SO); // The stack stays
+        unload_shared_objects(task);
+        fat32_close(fd);
+        return 0;
+    }
+
+    for (vm_region_t *region = task->regions; region; region = region->next)
+    {
+        if (region->type == VM_REGION_SEGMENT)
+            region->fd = fd;
+    }
+
+    task->fd = fd;
+    task->elf_info.next_so_base = image->next_so_base;
+    task->image = image;
+    image->ref_count++;
+
+    // Move to the front of the list
+    image_t **p = &image_list;
+    while (*p != image)
+        p = &(*p)->next;
+    *p = image->next;
+    image->next = image_list;
+    image_list = image;
+
+    printk("Started %s from the image cache\n", path);
+    return image->entry;
+}
+
+void image_cache_insert(const char *path, struct PCB *task, uintptr_t entry)
+{
+    if (strlen(path) >= IMAGE_PATH_MAX || !task->regions)
+        return;
+
+    fat32_dir_entry_t dir_entry;
+    if (fat32_stat(path, &dir_entry))
+        return;
+
+    image_t *old = image_find(path);
+    if (old)
+        image_evict(old);
+
+    // Make room by dropping the least recently used image nobody runs
+    if (num_images >= IMAGE_CACHE_MAX)
+    {
+        image_t *victim = NULL;
+        for (image_t *image = image_list; image; image = image->next)
+        {
+            if (image->ref_count == 0)
+                victim = image;
+        }
+
+        if (!victim)
+            return; // Every cached image is in use
+        image_evict(victim);
+    }
+
+    if (!image_cache)
+        image_cache = create_slab_cache(sizeof(image_t));
+
+    if (!image_cache)
+        return;
+
+    image_t *image = slab_alloc(image_cache);
+    if (!image)
+        return;
+
+    memset(image, 0, sizeof(image_t));
+    strcpy(image->path, path);
+    image->first_cluster = ((uint32_t)dir_entry.first_cluster_high << 16) | dir_entry.first_cluster_low;
+    image->file_size = dir_entry.file_size;
+    image->modify_date = dir_entry.modify_date;
+    image->modify_time = dir_entry.modify_time;
+    image->entry = entry;
+    image->next_so_base = task->elf_info.next_so_base;
+
+    uintptr_t start = (uintptr_t)-1;
+    uintptr_t end = 0;
+    for (vm_region_t *region = task->regions; region; region = region->next)
+    {
+        if (region->type != VM_REGION_SEGMENT)
+            continue;
+
+        if (region->start < start)
+            start = region->start;
+        if (region->end > end)
+            end = region->end;
+    }
+
+    if (!end)
+    {
+        image_free(image); // Nothing but stacks and shared objects
+        return;
+    }
+
+    image->start = start;
+    image->num_pages = (end - start) / SMALL_PAGE_SIZE;
+    image->pages = kmalloc(image->num_pages * sizeof(uintptr_t));
+    if (image->pages)
+        memset(image->pages, 0, image->num_pages * sizeof(uintptr_t));
+
+    if (!image->pages ||
+        vm_region_copy_list(&image->regions, task->regions, VM_REGION_SEGMENT) < 0 ||
+        copy_shared_object_list(&image->shared_objs, task->shared_objs) < 0)
+    {
+        image_free(image);
+        return;
+    }
+
+    // Keep the pages relocation already filled in, and share them copy-on-write from now on
+    for (size_t i = 0; i < image->num_pages; i++)
+    {
+        uintptr_t va = start + i * SMALL_PAGE_SIZE;
+        uint32_t l1_entry = task->pt[L1_INDEX(va)];
+        if (is_user_section_entry(l1_entry))
+        {
+            image->pages[i] = COARSE_PAGE_BASE(page_entry(task->pt, va));
+            page_get(ALLOC_4K, (void *)image->pages[i]);
+            task->pt[L1_INDEX(va)] = SECTION_SET_AP(l1_entry, AP_USER_READ);
+            continue;
+        }
+
+        if (!is_valid_l1_coarse_entry(l1_entry))
+            continue;
+
+        uint32_t *coarse_pt = (uint32_t *)COARSE_BASE(l1_entry);
+        uint32_t l2_entry = coarse_pt[L2_INDEX(va)];
+        if (!is_valid_l2_coarse_entry(l2_entry))
+            continue;
+
+        image->pages[i] = l2_page_base(l2_entry, va);
+        page_get(ALLOC_4K, (void *)image->pages[i]);
+        coarse_pt[L2_INDEX(va)] = L2_SET_AP(l2_entry, AP(AP_USER_READ));
+    }
+
+    image->ref_count = 1;
+    image->next = image_list;
+    image_list = image;
+    num_images++;
+
+    task->image = image;
+}
+
+uintptr_t image_cache_page(image_t *image, uintptr_t va)
+{
+    if (va < image->start)
+        return 0;
+
+    size_t index = (va - image->start) / SMALL_PAGE_SIZE;
+    if (index >= image->num_pages)
+        return 0;
+
+    return image->pages[index];
+}
+
+int8_t image_cache_add_page(image_t *image, uintptr_t va, uintptr_t page)
+{
+    if (va < image->start)
+        return -1;
+
+    size_t index = (va - image->start) / SMALL_PAGE_SIZE;
+    if (index >= image->num_pages || image->pages[index])
+        return -1;
+
+    image->pages[index] = page;
+    page_get(ALLOC_4K, (void *)page);
+
+    return 0;
+}
+
+void image_get(image_t *image)
+{
+    if (image)
+        image->ref_count++;
+}
+
+void image_put(image_t *image)
+{
+    if (!image)
+        return;
+
+    image->ref_count--;
+    if (image->ref_count == 0 && image->stale)
+        image_free(image);
+}
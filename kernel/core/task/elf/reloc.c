@@ -14,7 +14,8 @@ static int32_t apply_relocation_entry(
     const char *strtab,
     Elf32_Addr elf_mem,
     Elf32_Addr base_va,
-    struct PCB *task)
+    struct PCB *task,
+    user_walk_t *walk)
 {
     uint32_t sym_index = is_rela ? ELF32_R_SYM(reloc->rela->r_info) : ELF32_R_SYM(reloc->rel->r_info);
     uint32_t type = is_rela ? ELF32_R_TYPE(reloc->rela->r_info) : ELF32_R_TYPE(reloc->rel->r_info);
@@ -42,9 +43,17 @@ static int32_t apply_relocation_entry(
     {
     case R_ARM_GLOB_DAT:
     case R_ARM_JUMP_SLOT:
-        phys_addr = translate_addr(task->pt, target);
+        // The target may sit in a demand-paged segment that has not been touched yet
+        phys_addr = user_walk(walk, target);
+        if (!phys_addr)
+        {
+            printk("Relocation target %p not mapped\n", target);
+            return -5;
+        }
+
         printk("Symbol %s relocated to va %p, pa %p\n", name, addr, phys_addr);
         *phys_addr = addr;
+        dcache_clean_range((uintptr_t)phys_addr, sizeof(uint32_t)); // Written through the kernel mapping
         return 0;
     default:
         printk("Unsupported relocation type: %u\n", type);
@@ -79,6 +88,11 @@ int32_t apply_relocations(
         return -1;
     }
 
+    // Targets are mostly consecutive GOT slots: walk the page tables once per page.
+    // The task is not running yet, so read-only segments are patched in place.
+    user_walk_t walk;
+    user_walk_init(&walk, task, false);
+
     Elf32_Rel Rel;
     Elf32_Rela Rela;
     size_t count = rel_size / rel_ent;
@@ -93,7 +107,7 @@ int32_t apply_relocations(
             fat32_seek(fd, rel_addr + i * sizeof(Rel), SEEK_SET);
             fat32_read(fd, &Rel, sizeof(Rel));
 
-            result = apply_relocation_entry(fd, &reloc, false, symtab, strtab, elf_mem, base_va, task);
+            result = apply_relocation_entry(fd, &reloc, false, symtab, strtab, elf_mem, base_va, task, &walk);
         }
         else if (is_rela)
         {
@@ -102,7 +116,7 @@ int32_t apply_relocations(
             fat32_seek(fd, rel_addr + i * sizeof(Rela), SEEK_SET);
             fat32_read(fd, &Rela, sizeof(Rela));
 
-            result = apply_relocation_entry(fd, &reloc, true, symtab, strtab, elf_mem, base_va, task);
+            result = apply_relocation_entry(fd, &reloc, true, symtab, strtab, elf_mem, base_va, task, &walk);
         }
 
         if (result < 0)
@@ -24,6 +24,16 @@ static inline void add_to_global_list(so_entry_t *node)
     loaded_so_list = node;
 }
 
+static inline void remove_from_global_list(so_entry_t *node)
+{
+    so_entry_t **p = &loaded_so_list;
+    while (*p && *p != node)
+        p = &(*p)->next;
+
+    if (*p)
+        *p = node->next;
+}
+
 static inline bool in_task_list(const char *name, so_entry_task_t *list)
 {
     so_entry_task_t *cur = list;
@@ -51,21 +61,50 @@ static void add_to_task_list(so_entry_t *node, struct PCB *task)
     task->shared_objs = new_entry;
 }
 
-static void map_so(so_entry_t *so, struct PCB *task)
+/*
+ * Pages of a shared object are mapped read-only in every task, the one that
+ * loaded it included. The first write to a page gives the task its own copy
+ * (task_cow_fault()), so the library's data and bss are private to each task
+ * and the pages kept by the shared object stay as loaded.
+ */
+static void protect_so(so_entry_t *so, struct PCB *task, uintptr_t base_va)
 {
-    uintptr_t base_va = task->elf_info.next_so_base;
+    for (size_t i = 0; i < so->num_pages; i++)
+    {
+        uintptr_t va = base_va + so->pages[i].offset;
+        uint32_t l1_entry = task->pt[L1_INDEX(va)];
+        if (!so->pages[i].page_phys || !is_valid_l1_coarse_entry(l1_entry))
+            continue;
+
+        uint32_t *coarse_pt = (uint32_t *)COARSE_BASE(l1_entry);
+        if (is_valid_l2_coarse_entry(coarse_pt[L2_INDEX(va)]))
+            coarse_pt[L2_INDEX(va)] = L2_SET_AP(coarse_pt[L2_INDEX(va)], AP(AP_USER_READ));
+    }
+
+    tlb_invalidate_all();
+}
+
+static int8_t map_so(so_entry_t *so, struct PCB *task, uintptr_t base_va)
+{
+    // The region lets teardown find the pages without scanning the page tables
+    if (!vm_region_insert(task, base_va, base_va + so->num_pages * SMALL_PAGE_SIZE, AP_USER_RW, VM_REGION_SO))
+        return -1;
+
     uint32_t *l1 = task->pt;
     for (size_t i = 0; i < so->num_pages; i++)
     {
         uintptr_t page_phys = so->pages[i].page_phys;
         uintptr_t va = base_va + so->pages[i].offset;
 
-        uint32_t l1_entry = l1[L1_INDEX(va)];
-        if (is_valid_l1_coarse_entry(l1_entry))
-            map_page(COARSE_BASE(l1_entry), va, page_phys, AP(AP_USER_RW));
+        uint32_t *coarse_pt = get_coarse_table(l1, va, DOMAIN_KERNEL);
+        if (!coarse_pt)
+            continue;
+
+        map_page((uintptr_t)coarse_pt, va, page_phys, AP(AP_USER_READ)); // Copied on the first write, see protect_so()
+        page_get(ALLOC_4K, (void *)page_phys); // Every mapping holds a reference
     }
 
-    task->elf_info.next_so_base += so->num_pages * SMALL_PAGE_SIZE;
+    return 0;
 }
 
 int8_t load_shared_object(const char *name, struct PCB *task)
@@ -99,23 +138,76 @@ int8_t load_shared_object(const char *name, struct PCB *task)
 
         found->ref_count++;
         add_to_task_list(found, task);
-        map_so(found, task);
+        if (map_so(found, task, task->elf_info.next_so_base) < 0)
+            return -1;
+        task->elf_info.next_so_base += found->num_pages * SMALL_PAGE_SIZE;
         return 0;
     }
 
     /* Not loaded globally (brand new SO) */
     printk("Brand new SO\n");
     so_entry_t *new_so = slab_alloc(so_entry_cache);
-    new_so->name = name;
+    new_so->name = strdup(name); // name lives in the loading task's string table
     new_so->next = NULL;
-    new_so->ref_count = 0;
+    new_so->ref_count = 1;
 
     add_to_global_list(new_so);
     add_to_task_list(new_so, task);
 
+    uintptr_t base_va = task->elf_info.next_so_base;
     if (elf_load_internal(name, task, true, NULL, new_so) < 0)
         return -1;
 
+    // Relocated: from now on writes go to private copies
+    protect_so(new_so, task, base_va);
+
+    return 0;
+}
+
+int8_t copy_shared_object_list(so_entry_task_t **dst, so_entry_task_t *src)
+{
+    so_entry_task_t **tail = dst;
+    while (*tail)
+        tail = &(*tail)->next;
+
+    for (so_entry_task_t *node = src; node; node = node->next)
+    {
+        so_entry_task_t *copy = slab_alloc(so_entry_task_cache);
+        if (!copy)
+            return -1;
+
+        copy->so = node->so;
+        copy->base_va = node->base_va;
+        copy->next = NULL;
+        node->so->ref_count++;
+
+        *tail = copy;
+        tail = &copy->next;
+    }
+
+    return 0;
+}
+
+int8_t copy_shared_objects(struct PCB *dst, struct PCB *src)
+{
+    return copy_shared_object_list(&dst->shared_objs, src->shared_objs);
+}
+
+int8_t attach_shared_objects(struct PCB *task, so_entry_task_t *list)
+{
+    so_entry_task_t **tail = &task->shared_objs;
+    while (*tail)
+        tail = &(*tail)->next;
+
+    if (copy_shared_object_list(tail, list) < 0)
+        return -1;
+
+    for (so_entry_task_t *node = *tail; node; node = node->next)
+    {
+        if (map_so(node->so, task, node->base_va) < 0)
+            return -1;
+    }
+
     return 0;
 }
 
@@ -167,9 +259,9 @@ uintptr_t resolve_symbol(const char *sym_name, so_entry_task_t *list)
     return 0;
 }
 
-void unload_shared_objects(struct PCB *task)
+void release_shared_object_list(so_entry_task_t **list)
 {
-    so_entry_task_t *node = task->shared_objs;
+    so_entry_task_t *node = *list;
     so_entry_task_t *next;
 
     while (node)
@@ -182,6 +274,16 @@ void unload_shared_objects(struct PCB *task)
             cur->ref_count--;
             if (cur->ref_count == 0)
             {
+                remove_from_global_list(cur);
+
+                // Drop the references taken when the pages were loaded
+                for (size_t i = 0; i < cur->num_pages; i++)
+                {
+                    if (cur->pages[i].page_phys)
+                        page_put(ALLOC_4K, (void *)cur->pages[i].page_phys);
+                }
+
+                kfree(cur->name);
                 kfree(cur->strtab);
                 kfree(cur->symtab);
                 kfree(cur->hash.bucket);
@@ -196,5 +298,10 @@ void unload_shared_objects(struct PCB *task)
         node = next;
     }
 
-    task->shared_objs = NULL;
+    *list = NULL;
+}
+
+void unload_shared_objects(struct PCB *task)
+{
+    release_shared_object_list(&task->shared_objs);
 }
@@ -0,0 +1,285 @@
+#include <kernel/core/task/files.h>
+#include <kernel/arch/arm/svc.h>
+#include <kernel/core/task/elf/image_cache.h>
+
+// Whether a FILE_PIPE descriptor is the write end of its pipe
+static inline bool file_pipe_writes(task_file_t *file)
+{
+    return (file->flags & O_ACCMODE) == O_WRONLY;
+}
+
+// Descriptor fd of the current task, or NULL if it is not open
+static task_file_t *file_get(int32_t fd)
+{
+    if (!current || fd < 0 || fd >= TASK_MAX_FILES)
+        return NULL;
+
+    // Threads share the descriptors of their leader
+    task_file_t *file = &current->leader->files[fd];
+    return file->fd == FILE_CLOSED ? NULL : file;
+}
+
+// Lowest free descriptor of the current task from first on, or -1 if there is none
+static int32_t file_alloc(int32_t first)
+{
+    task_file_t *files = current->leader->files;
+    int32_t fd = first;
+    while (fd < TASK_MAX_FILES && files[fd].fd != FILE_CLOSED)
+        fd++;
+
+    return fd == TASK_MAX_FILES ? -1 : fd;
+}
+
+// Drops the cached pages and executable image of the file behind a FAT32 descriptor before it changes
+static void file_invalidate_pages(int8_t fat_fd)
+{
+    fat32_dir_entry_t entry;
+    if (fat32_fstat(fat_fd, &entry) < 0)
+        return;
+
+    uint32_t cluster = ((uint32_t)entry.first_cluster_high << 16) | entry.first_cluster_low;
+    page_cache_invalidate(cluster);
+    image_cache_invalidate(cluster);
+}
+
+void files_init(struct PCB *task)
+{
+    for (size_t i = 0; i < TASK_MAX_FILES; i++)
+    {
+        task->files[i].fd = i <= STDERR_FILENO ? FILE_CONSOLE : FILE_CLOSED;
+        task->files[i].flags = i == STDIN_FILENO ? O_RDONLY : O_WRONLY;
+        task->files[i].pipe = NULL;
+    }
+}
+
+int8_t files_copy(struct PCB *dst, struct PCB *src)
+{
+    for (size_t i = 0; i < TASK_MAX_FILES; i++)
+    {
+        dst->files[i] = src->files[i];
+        if (src->files[i].fd == FILE_PIPE)
+            pipe_get(src->files[i].pipe, file_pipe_writes(&src->files[i]));
+
+        if (src->files[i].fd < 0)
+            continue;
+
+        dst->files[i].fd = fat32_dup(src->files[i].fd);
+        if (dst->files[i].fd < 0)
+        {
+            while (i--)
+            {
+                if (dst->files[i].fd >= 0)
+                    fat32_close(dst->files[i].fd);
+                else if (dst->files[i].fd == FILE_PIPE)
+                    pipe_put(dst->files[i].pipe, file_pipe_writes(&dst->files[i]));
+            }
+
+            for (i = 0; i < TASK_MAX_FILES; i++)
+                dst->files[i].fd = FILE_CLOSED;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void files_close_all(struct PCB *task)
+{
+    for (size_t i = 0; i < TASK_MAX_FILES; i++)
+    {
+        if (task->files[i].fd >= 0)
+            fat32_close(task->files[i].fd);
+        else if (task->files[i].fd == FILE_PIPE)
+            pipe_put(task->files[i].pipe, file_pipe_writes(&task->files[i]));
+        task->files[i].fd = FILE_CLOSED;
+        task->files[i].pipe = NULL;
+    }
+}
+
+int32_t file_open(const char *path, uint32_t flags)
+{
+    char kpath[FILE_PATH_MAX];
+    if (strncpy_from_user(kpath, path, sizeof(kpath)) < 0)
+        return -1;
+
+    task_file_t *files = current->leader->files;
+    int32_t fd = file_alloc(0);
+    if (fd < 0)
+        return -1; // Descriptor table full
+
+    int8_t fat_fd = fat32_open(kpath);
+    if (fat_fd == -1 && (flags & O_CREAT))
+    {
+        if (fat32_create_file(kpath) < 0)
+            return -1;
+        fat_fd = fat32_open(kpath);
+    }
+
+    if (fat_fd < 0)
+        return -1;
+
+    if ((flags & O_TRUNC) && (flags & O_ACCMODE) != O_RDONLY)
+    {
+        file_invalidate_pages(fat_fd);
+        if (fat32_truncate(fat_fd, 0) < 0)
+        {
+            fat32_close(fat_fd);
+            return -1;
+        }
+    }
+
+    files[fd].fd = fat_fd;
+    files[fd].flags = flags;
+
+    return fd;
+}
+
+int32_t file_read(int32_t fd, void *buf, size_t n)
+{
+    task_file_t *file = file_get(fd);
+    if (!file || (file->flags & O_ACCMODE) == O_WRONLY)
+        return -1;
+
+    if (n == 0)
+        return 0;
+
+    if (file->fd == FILE_CONSOLE)
+        return -1; // There is no console input for tasks
+
+    if (file->fd == FILE_PIPE)
+        return pipe_read(file->pipe, buf, n);
+
+    // Fault in and unshare the whole buffer up front, the driver then writes into it directly
+    if (user_prepare_write(buf, n) < 0)
+        return -1;
+
+    return fat32_read(file->fd, buf, n);
+}
+
+int32_t file_write(int32_t fd, const void *buf, size_t n)
+{
+    task_file_t *file = file_get(fd);
+    if (!file || (file->flags & O_ACCMODE) == O_RDONLY)
+        return -1;
+
+    if (n == 0)
+        return 0;
+
+    if (file->fd == FILE_PIPE)
+        return pipe_write(file->pipe, buf, n);
+
+    // Drivers read buf directly, so every page must be present first
+    if (user_prepare_read(buf, n) < 0)
+        return -1;
+
+    if (file->fd == FILE_CONSOLE)
+    {
+        uart_write(uart0, buf, n);
+        return n;
+    }
+
+    if ((file->flags & O_APPEND) && fat32_seek(file->fd, 0, SEEK_END) < 0)
+        return -1;
+
+    file_invalidate_pages(file->fd);
+    return fat32_write(file->fd, (uint8_t *)buf, n);
+}
+
+int32_t file_lseek(int32_t fd, int32_t offset, uint32_t whence)
+{
+    task_file_t *file = file_get(fd);
+    if (!file || file->fd < 0 || whence > SEEK_END)
+        return -1;
+
+    if (fat32_seek(file->fd, offset, (seek_op_t)whence) < 0)
+        return -1;
+
+    return fat32_tell(file->fd);
+}
+
+int32_t file_close(int32_t fd)
+{
+    task_file_t *file = file_get(fd);
+    if (!file)
+        return -1;
+
+    if (file->fd >= 0)
+        fat32_close(file->fd);
+    else if (file->fd == FILE_PIPE)
+        pipe_put(file->pipe, file_pipe_writes(file));
+    file->fd = FILE_CLOSED;
+    file->pipe = NULL;
+
+    return 0;
+}
+
+int32_t file_stat(const char *path, stat_t *out)
+{
+    char kpath[FILE_PATH_MAX];
+    if (strncpy_from_user(kpath, path, sizeof(kpath)) < 0)
+        return -1;
+
+    fat32_dir_entry_t entry;
+    if (fat32_stat(kpath, &entry))
+        return -1;
+
+    stat_t st;
+    st.size = entry.file_size;
+    st.attr = entry.attr;
+    st.modify_date = entry.modify_date;
+    st.modify_time = entry.modify_time;
+
+    return copy_to_user(out, &st, sizeof(st));
+}
+
+// A pipe descriptor that would block puts the caller to sleep, unless it was made O_NONBLOCK
+static int32_t file_wait(int32_t fd, int32_t ret, struct regs *regs)
+{
+    if (ret != PIPE_WOULD_BLOCK)
+        return ret;
+
+    task_file_t *file = file_get(fd);
+    if (!file || file->fd != FILE_PIPE || (file->flags & O_NONBLOCK))
+        return ret;
+
+    return pipe_sleep(file->pipe, regs);
+}
+
+int32_t file_read_wait(struct regs *regs)
+{
+    int32_t fd = regs->r0;
+    return file_wait(fd, file_read(fd, (void *)regs->r1, regs->r2), regs);
+}
+
+int32_t file_write_wait(struct regs *regs)
+{
+    int32_t fd = regs->r0;
+    return file_wait(fd, file_write(fd, (const void *)regs->r1, regs->r2), regs);
+}
+
+int32_t file_pipe(int32_t *fds, uint32_t flags, uint32_t num_pages)
+{
+    if (user_prepare_write(fds, 2 * sizeof(int32_t)) < 0)
+        return -1;
+
+    task_file_t *files = current->leader->files;
+    int32_t read_fd = file_alloc(0);
+    int32_t write_fd = read_fd < 0 ? -1 : file_alloc(read_fd + 1);
+    if (write_fd < 0)
+        return -1; // Descriptor table full
+
+    pipe_t *pipe = pipe_create(num_pages);
+    if (!pipe)
+        return -1;
+
+    files[read_fd].fd = FILE_PIPE;
+    files[read_fd].flags = O_RDONLY | (flags & O_NONBLOCK);
+    files[read_fd].pipe = pipe;
+
+    files[write_fd].fd = FILE_PIPE;
+    files[write_fd].flags = O_WRONLY | (flags & O_NONBLOCK);
+    files[write_fd].pipe = pipe;
+
+    int32_t kfds[2] = {read_fd, write_fd};
+    return copy_to_user(fds, kfds, sizeof(kfds));
+}
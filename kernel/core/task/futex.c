@@ -0,0 +1,99 @@
+#include <kernel/core/task/futex.h>
+
+static struct PCB *futex_queues[FUTEX_HASH_SIZE]; // FIFO lists linked through futex_next
+
+static struct PCB **futex_bucket(uintptr_t key)
+{
+    return &futex_queues[((key >> 2) ^ (key >> 12)) & (FUTEX_HASH_SIZE - 1)];
+}
+
+// Physical address of a user word, after making its page present and private
+static uintptr_t futex_key(uint32_t *uaddr)
+{
+    if ((uintptr_t)uaddr & 3)
+        return 0;
+
+    if (user_prepare_write(uaddr, sizeof(uint32_t)) < 0)
+        return 0;
+
+    return (uintptr_t)translate_addr(current->pt, (uintptr_t)uaddr);
+}
+
+int32_t futex_wait(uint32_t *uaddr, uint32_t expected)
+{
+    uintptr_t key = futex_key(uaddr);
+    if (!key)
+        return -1;
+
+    uint32_t irq = irq_save();
+
+    // The value is checked and the task queued without a wake in between
+    if (*uaddr != expected)
+    {
+        irq_restore(irq);
+        return -2;
+    }
+
+    struct PCB **p = futex_bucket(key);
+    while (*p)
+        p = &(*p)->futex_next;
+
+    current->futex_key = key;
+    current->futex_next = NULL;
+    *p = current;
+    current->state = BLOCKED;
+
+    irq_restore(irq);
+
+    // The switch happens on the way back to user mode, which resumes after the svc with r0 = 0
+    task_yield();
+    return 0;
+}
+
+int32_t futex_wake(uint32_t *uaddr, uint32_t count)
+{
+    uintptr_t key = futex_key(uaddr);
+    if (!key)
+        return -1;
+
+    uint32_t irq = irq_save();
+
+    int32_t woken = 0;
+    struct PCB **p = futex_bucket(key);
+    while (*p && (uint32_t)woken < count)
+    {
+        struct PCB *task = *p;
+        if (task->futex_key != key)
+        {
+            p = &task->futex_next;
+            continue;
+        }
+
+        *p = task->futex_next;
+        task->futex_key = 0;
+        task->futex_next = NULL;
+        task_wake(task);
+        woken++;
+    }
+
+    irq_restore(irq);
+
+    return woken;
+}
+
+void futex_cancel(struct PCB *task)
+{
+    uint32_t irq = irq_save();
+
+    struct PCB **p = futex_bucket(task->futex_key);
+    while (*p && *p != task)
+        p = &(*p)->futex_next;
+
+    if (*p)
+        *p = task->futex_next;
+
+    task->futex_key = 0;
+    task->futex_next = NULL;
+
+    irq_restore(irq);
+}
@@ -0,0 +1,293 @@
+#include <kernel/core/task/ipc.h>
+#include <kernel/arch/arm/svc.h>
+#include <kernel/arch/arm/cache.h>
+
+static ipc_port_t ports[IPC_MAX_PORTS];
+static slab_cache_t *kmsg_cache = NULL;
+
+// Page table entry slot mapping va in the current task, or NULL if there is none
+static uint32_t *ipc_pte(uintptr_t va)
+{
+    uint32_t l1_entry = current->pt[L1_INDEX(va)];
+    if (!is_valid_l1_coarse_entry(l1_entry))
+        return NULL;
+
+    return &((uint32_t *)COARSE_BASE(l1_entry))[L2_INDEX(va)];
+}
+
+static ipc_port_t *port_get(int32_t port)
+{
+    if (port < 0 || port >= IPC_MAX_PORTS || !ports[port].owner)
+        return NULL;
+
+    return &ports[port];
+}
+
+// Frees a message that will never be received, with the pages it carries
+static void kmsg_drop(ipc_kmsg_t *kmsg)
+{
+    for (uint32_t i = 0; i < kmsg->num_pages; i++)
+        page_put(ALLOC_4K, (void *)kmsg->pages[i]);
+
+    if (kmsg->sender)
+    {
+        kmsg->sender->context[CTX_R0] = (uint32_t)-1; // The send fails
+        kmsg->sender->ipc_send = NULL;
+        task_wake(kmsg->sender);
+    }
+
+    slab_free(kmsg_cache, kmsg);
+}
+
+int32_t ipc_port_create(void)
+{
+    if (!current || current->kernel)
+        return -1;
+
+    for (int32_t i = 0; i < IPC_MAX_PORTS; i++)
+    {
+        if (!ports[i].owner)
+        {
+            memset(&ports[i], 0, sizeof(ipc_port_t));
+            ports[i].owner = current->leader;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void port_release(ipc_port_t *port)
+{
+    while (port->head)
+    {
+        ipc_kmsg_t *kmsg = port->head;
+        port->head = kmsg->next;
+        kmsg_drop(kmsg);
+    }
+
+    if (port->receiver)
+        task_wake(port->receiver); // Its restarted receive fails on the freed port
+
+    memset(port, 0, sizeof(ipc_port_t));
+}
+
+int32_t ipc_port_destroy(int32_t port)
+{
+    ipc_port_t *p = port_get(port);
+    if (!p || p->owner != current->leader)
+        return -1;
+
+    port_release(p);
+    return 0;
+}
+
+void ipc_release_ports(struct PCB *task)
+{
+    for (size_t i = 0; i < IPC_MAX_PORTS; i++)
+    {
+        if (ports[i].owner == task)
+            port_release(&ports[i]);
+    }
+}
+
+// Checks that n pages at va may be given away, and makes them present and private
+static int8_t ipc_prepare_pages(uintptr_t va, uint32_t n)
+{
+    if (va & PAGE_OFFSET_MASK || n > IPC_MAX_PAGES)
+        return -1;
+
+    for (uint32_t i = 0; i < n; i++, va += SMALL_PAGE_SIZE)
+    {
+        // Shared memory pages belong to their object, file pages to the page cache and the ring page to the kernel
+        if ((va >= TASK_SHM_BASE && va < TASK_STACK_BASE) || (va >= TASK_MMAP_BASE && va < TASK_MMAP_END))
+            return -1;
+
+        if (user_prepare_write((void *)va, SMALL_PAGE_SIZE) < 0)
+            return -1;
+
+        // The page leaves on its own, out of any large page or section around it
+        if (split_page_mapping(current->pt, va) < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+int32_t ipc_send(int32_t port, const ipc_msg_t *msg, uint32_t flags)
+{
+    ipc_port_t *p = port_get(port);
+    if (!p)
+        return -1;
+
+    // A task waiting on its own port would never be woken
+    if (!(flags & IPC_ASYNC) && p->owner == current->leader)
+        return -1;
+
+    if (p->count >= IPC_QUEUE_MAX)
+        return -2;
+
+    ipc_msg_t req;
+    if (copy_from_user(&req, msg, sizeof(ipc_msg_t)) < 0)
+        return -1;
+
+    if (req.len > IPC_INLINE_MAX || ipc_prepare_pages((uintptr_t)req.pages, req.num_pages) < 0)
+        return -1;
+
+    if (!kmsg_cache)
+        kmsg_cache = create_slab_cache(sizeof(ipc_kmsg_t));
+
+    ipc_kmsg_t *kmsg = kmsg_cache ? slab_alloc(kmsg_cache) : NULL;
+    if (!kmsg)
+        return -1;
+
+    memset(kmsg, 0, sizeof(ipc_kmsg_t));
+    kmsg->tag = req.tag;
+    kmsg->len = req.len;
+    memcpy(kmsg->data, req.data, req.len);
+    kmsg->sender_pid = current->pid;
+
+    // Move the payload: the sender's reference on each page passes to the message
+    uintptr_t va = (uintptr_t)req.pages;
+    for (uint32_t i = 0; i < req.num_pages; i++, va += SMALL_PAGE_SIZE)
+    {
+        uint32_t *pte = ipc_pte(va);
+
+        dcache_flush_range(va, SMALL_PAGE_SIZE); // The page changes hands
+        kmsg->pages[i] = COARSE_PAGE_BASE(*pte);
+        *pte = 0;
+        tlb_invalidate_va(va);
+    }
+    kmsg->num_pages = req.num_pages;
+
+    if (p->tail)
+        p->tail->next = kmsg;
+    else
+        p->head = kmsg;
+    p->tail = kmsg;
+    p->count++;
+
+    if (p->receiver)
+    {
+        task_wake(p->receiver);
+        p->receiver = NULL;
+    }
+
+    if (!(flags & IPC_ASYNC))
+    {
+        // Sleep until the receiver takes the message, it resumes us with r0 = 0
+        kmsg->sender = current;
+        current->ipc_send = kmsg;
+        current->state = BLOCKED;
+        task_yield();
+    }
+
+    return 0;
+}
+
+// Maps the pages of kmsg over the receive window at va of the current task
+static int8_t ipc_map_pages(ipc_kmsg_t *kmsg, uintptr_t va, uint32_t capacity)
+{
+    if (kmsg->num_pages > capacity || va & PAGE_OFFSET_MASK)
+        return -1;
+
+    struct PCB *task = current->leader;
+
+    for (uint32_t i = 0; i < kmsg->num_pages; i++)
+    {
+        uintptr_t page_va = va + i * SMALL_PAGE_SIZE;
+        if (!user_range_ok((void *)page_va, SMALL_PAGE_SIZE) || !task_va_writable(task, page_va) ||
+            (page_va >= TASK_SHM_BASE && page_va < TASK_STACK_BASE) ||
+            (page_va >= TASK_MMAP_BASE && page_va < TASK_MMAP_END))
+            return -1;
+
+        if (split_page_mapping(task->pt, page_va) < 0 || !get_coarse_table(task->pt, page_va, DOMAIN_USER))
+            return -1;
+    }
+
+    for (uint32_t i = 0; i < kmsg->num_pages; i++, va += SMALL_PAGE_SIZE)
+    {
+        uint32_t *pte = ipc_pte(va);
+        if (is_valid_l2_coarse_entry(*pte))
+        {
+            dcache_flush_range(va, SMALL_PAGE_SIZE);
+            page_put(ALLOC_4K, (void *)COARSE_PAGE_BASE(*pte));
+        }
+
+        map_page(COARSE_BASE(task->pt[L1_INDEX(va)]), va, kmsg->pages[i], AP(AP_USER_RW));
+        tlb_invalidate_va(va);
+    }
+
+    return 0;
+}
+
+int32_t ipc_receive(struct regs *regs)
+{
+    ipc_port_t *p = port_get(regs->r0);
+    ipc_msg_t *msg = (ipc_msg_t *)regs->r1;
+
+    if (!p || p->owner != current->leader || user_prepare_write(msg, sizeof(ipc_msg_t)) < 0)
+        return -1;
+
+    ipc_kmsg_t *kmsg = p->head;
+    if (!kmsg)
+    {
+        if (regs->r2 & IPC_NONBLOCK)
+            return -2;
+
+        // Block, and execute the svc again once a message arrives
+        p->receiver = current;
+        current->state = BLOCKED;
+        regs->lr -= 4;
+        task_yield();
+        return regs->r0; // Arguments must be intact for the restarted call
+    }
+
+    ipc_msg_t out;
+    memcpy(&out, msg, sizeof(ipc_msg_t));
+
+    if (kmsg->num_pages && ipc_map_pages(kmsg, (uintptr_t)out.pages, out.num_pages) < 0)
+        return -1; // The message stays queued for a receive with a suitable window
+
+    out.tag = kmsg->tag;
+    out.len = kmsg->len;
+    memcpy(out.data, kmsg->data, kmsg->len);
+    out.num_pages = kmsg->num_pages;
+    if (!kmsg->num_pages)
+        out.pages = NULL;
+    out.sender = kmsg->sender_pid;
+    memcpy(msg, &out, sizeof(ipc_msg_t));
+
+    if (p->receiver == current)
+        p->receiver = NULL;
+
+    p->head = kmsg->next;
+    if (!p->head)
+        p->tail = NULL;
+    p->count--;
+
+    if (kmsg->sender)
+    {
+        kmsg->sender->ipc_send = NULL;
+        task_wake(kmsg->sender);
+    }
+
+    slab_free(kmsg_cache, kmsg);
+
+    return 0;
+}
+
+void ipc_cancel(struct PCB *task)
+{
+    if (task->ipc_send)
+    {
+        task->ipc_send->sender = NULL;
+        task->ipc_send = NULL;
+    }
+
+    for (size_t i = 0; i < IPC_MAX_PORTS; i++)
+    {
+        if (ports[i].receiver == task)
+            ports[i].receiver = NULL;
+    }
+}
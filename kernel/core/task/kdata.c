@@ -0,0 +1,84 @@
+#include <kernel/core/task/kdata.h>
+#include <kernel/core/task/task.h>
+#include <kernel/arch/arm/interrupt.h>
+
+static kdata_t *kdata = NULL; // Written through the kernel's uncached identity mapping
+
+int8_t kdata_init(void)
+{
+    kdata = alloc_page(ALLOC_4K);
+    if (!kdata)
+        return -1;
+
+    memset(kdata, 0, SMALL_PAGE_SIZE);
+    return 0;
+}
+
+int8_t kdata_map(uint32_t *pt)
+{
+    if (!kdata)
+        return -1;
+
+    // Both pages sit in the same section, below the ring page
+    uint32_t *coarse_pt = get_coarse_table(pt, KDATA_BASE, DOMAIN_USER);
+    if (!coarse_pt)
+        return -1;
+
+    // Uncached, so a task never reads a stale line of a page the kernel keeps rewriting
+    coarse_pt[L2_INDEX(KDATA_BASE)] = L2_PAGE_ENTRY((uintptr_t)kdata, AP(AP_USER_READ), 0, 0);
+    coarse_pt[L2_INDEX(KDATA_TIMER_BASE)] = L2_PAGE_ENTRY(TIMER0_BASE, AP(AP_USER_READ), 0, 0);
+
+    return 0;
+}
+
+static inline void kdata_write_begin(void)
+{
+    kdata->seq++;
+    asm volatile("" : : : "memory");
+}
+
+static inline void kdata_write_end(void)
+{
+    asm volatile("" : : : "memory");
+    kdata->seq++;
+}
+
+static inline void kdata_update_clock(void)
+{
+    uint32_t count;
+    kdata->clock_base_us = clock_us_count(&count);
+    kdata->clock_last = count;
+}
+
+void kdata_tick(void)
+{
+    if (!kdata)
+        return;
+
+    unsigned int flags = irq_save();
+    kdata_write_begin();
+
+    kdata->ticks++;
+    kdata_update_clock();
+
+    kdata_write_end();
+    irq_restore(flags);
+}
+
+void kdata_switch(struct PCB *task, uint32_t nr_tasks)
+{
+    if (!kdata)
+        return;
+
+    unsigned int flags = irq_save();
+    kdata_write_begin();
+
+    kdata->switches++;
+    kdata->pid = task->pid;
+    kdata->tgid = task->leader->pid;
+    kdata->nr_tasks = nr_tasks;
+    kdata_update_clock();
+
+    kdata_write_end();
+    irq_restore(flags);
+}
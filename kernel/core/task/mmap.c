@@ -0,0 +1,287 @@
+#include <kernel/core/task/mmap.h>
+#include <kernel/core/task/task.h>
+#include <kernel/arch/arm/cache.h>
+
+static slab_cache_t *mmap_cache = NULL;
+
+// Page table entry slot mapping va in task, or NULL if va has no coarse table
+static uint32_t *mmap_pte(struct PCB *task, uintptr_t va)
+{
+    uint32_t l1_entry = task->pt[L1_INDEX(va)];
+    if (!is_valid_l1_coarse_entry(l1_entry))
+        return NULL;
+
+    return &((uint32_t *)COARSE_BASE(l1_entry))[L2_INDEX(va)];
+}
+
+static inline uint32_t mmap_index(mmap_area_t *area, uintptr_t va)
+{
+    return area->pgoff + (va - area->start) / SMALL_PAGE_SIZE;
+}
+
+mmap_area_t *mmap_find(struct PCB *task, uintptr_t va)
+{
+    for (mmap_area_t *area = task->mmaps; area; area = area->next)
+    {
+        if (va >= area->start && va < area->end)
+            return area;
+    }
+
+    return NULL;
+}
+
+// First address of the mapping window with size free bytes
+static uintptr_t mmap_find_va(struct PCB *task, size_t size)
+{
+    uintptr_t va = TASK_MMAP_BASE;
+
+    while (va + size <= TASK_MMAP_END && va + size > va)
+    {
+        mmap_area_t *overlap = NULL;
+        for (mmap_area_t *area = task->mmaps; area && !overlap; area = area->next)
+        {
+            if (va < area->end && area->start < va + size)
+                overlap = area;
+        }
+
+        if (!overlap)
+            return va;
+
+        va = overlap->end;
+    }
+
+    return 0;
+}
+
+int32_t mmap_map(int32_t fd, uint32_t offset, size_t length, uint32_t prot)
+{
+    if (!current || current->kernel || fd < 0 || fd >= TASK_MAX_FILES || length == 0 || (offset & PAGE_OFFSET_MASK))
+        return -1;
+
+    struct PCB *task = current->leader;
+    task_file_t *file = &task->files[fd];
+    if (file->fd < 0 || !(prot & PROT_READ))
+        return -1; // Only files on the SD card can be mapped
+
+    bool writable = prot & PROT_WRITE;
+    if (writable && (file->flags & O_ACCMODE) == O_RDONLY)
+        return -1;
+
+    fat32_dir_entry_t entry;
+    if (fat32_fstat(file->fd, &entry) < 0)
+        return -1;
+
+    uint32_t cluster = ((uint32_t)entry.first_cluster_high << 16) | entry.first_cluster_low;
+    if (cluster < 2 || offset >= entry.file_size)
+        return -1; // Empty files have no cluster to key their pages
+
+    size_t size = (length + PAGE_OFFSET_MASK) & PAGE_MASK;
+    uintptr_t va = size ? mmap_find_va(task, size) : 0;
+    if (!va)
+        return -1;
+
+    if (!mmap_cache)
+        mmap_cache = create_slab_cache(sizeof(mmap_area_t));
+
+    mmap_area_t *area = mmap_cache ? slab_alloc(mmap_cache) : NULL;
+    if (!area)
+        return -1;
+
+    area->fd = fat32_dup(file->fd);
+    if (area->fd < 0)
+    {
+        slab_free(mmap_cache, area);
+        return -1;
+    }
+
+    area->start = va;
+    area->end = va + size;
+    area->cluster = cluster;
+    area->pgoff = offset / SMALL_PAGE_SIZE;
+    area->file_size = entry.file_size;
+    area->writable = writable;
+    area->next = task->mmaps;
+    task->mmaps = area;
+
+    return va;
+}
+
+int8_t mmap_fault(struct PCB *task, uintptr_t va)
+{
+    mmap_area_t *area = mmap_find(task, va);
+    if (!area)
+        return -1;
+
+    uintptr_t page_va = va & PAGE_MASK;
+    uint32_t *coarse_pt = get_coarse_table(task->pt, page_va, DOMAIN_USER);
+    if (!coarse_pt)
+        return -3;
+
+    if (is_valid_l2_coarse_entry(coarse_pt[L2_INDEX(page_va)]))
+        return 0; // Already present
+
+    page_cache_entry_t *entry = page_cache_get(area->fd, area->cluster, mmap_index(area, page_va), area->file_size);
+    if (!entry)
+        return -2;
+
+    // Read-only even in a writable mapping: the first write faults and marks the page dirty
+    page_get(ALLOC_4K, (void *)entry->page);
+    coarse_pt[L2_INDEX(page_va)] = L2_PAGE_ENTRY(entry->page, AP(AP_USER_READ), C_WB, B_BUF);
+
+    return 0;
+}
+
+int8_t mmap_write_fault(struct PCB *task, uintptr_t va)
+{
+    mmap_area_t *area = mmap_find(task, va);
+    if (!area || !area->writable)
+        return -1;
+
+    uintptr_t page_va = va & PAGE_MASK;
+    uint32_t *pte = mmap_pte(task, page_va);
+    if (!pte || !is_valid_l2_coarse_entry(*pte))
+        return -1;
+
+    page_cache_entry_t *entry = page_cache_find(area->cluster, mmap_index(area, page_va));
+    if (!entry || COARSE_PAGE_BASE(*pte) != entry->page)
+        return -1;
+
+    if (L2_GET_AP(*pte) != AP(AP_USER_RW))
+    {
+        *pte = L2_SET_AP(*pte, AP(AP_USER_RW));
+        tlb_invalidate_va(page_va);
+        entry->writers++;
+    }
+
+    entry->dirty = true;
+    return 0;
+}
+
+/*
+ * Writes back the pages of area in [from, to) that the file needs. Pages
+ * this task has writable are flushed from the data cache and made read-only
+ * again, so later writes are tracked. With unmap, the pages are also removed
+ * from the task.
+ */
+static int8_t mmap_sync_range(struct PCB *task, mmap_area_t *area, uintptr_t from, uintptr_t to, bool unmap)
+{
+    int8_t ret = 0;
+
+    for (uintptr_t va = from; va < to; va += SMALL_PAGE_SIZE)
+    {
+        uint32_t *pte = mmap_pte(task, va);
+        bool mapped = pte && is_valid_l2_coarse_entry(*pte);
+        page_cache_entry_t *entry = page_cache_find(area->cluster, mmap_index(area, va));
+
+        if (mapped && L2_GET_AP(*pte) == AP(AP_USER_RW))
+        {
+            dcache_flush_range(va, SMALL_PAGE_SIZE); // The kernel writes the page back through its own mapping
+            *pte = L2_SET_AP(*pte, AP(AP_USER_READ));
+            tlb_invalidate_va(va);
+            if (entry && entry->writers)
+                entry->writers--;
+        }
+
+        if (entry && page_cache_writeback(entry, area->fd, area->file_size) < 0)
+            ret = -1;
+
+        if (mapped && unmap)
+        {
+            page_put(ALLOC_4K, (void *)COARSE_PAGE_BASE(*pte));
+            *pte = 0;
+            tlb_invalidate_va(va);
+        }
+    }
+
+    return ret;
+}
+
+// Unlinks, writes back and undoes one mapping of task
+static int8_t mmap_release(struct PCB *task, mmap_area_t **p)
+{
+    mmap_area_t *area = *p;
+    *p = area->next;
+
+    int8_t ret = mmap_sync_range(task, area, area->start, area->end, true);
+
+    fat32_close(area->fd);
+    slab_free(mmap_cache, area);
+
+    return ret;
+}
+
+int32_t mmap_unmap(uintptr_t va)
+{
+    if (!current)
+        return -1;
+
+    struct PCB *task = current->leader;
+    for (mmap_area_t **p = &task->mmaps; *p; p = &(*p)->next)
+    {
+        if ((*p)->start == va)
+            return mmap_release(task, p);
+    }
+
+    return -1;
+}
+
+int32_t mmap_sync(uintptr_t va, size_t length)
+{
+    if (!current || length == 0)
+        return -1;
+
+    struct PCB *task = current->leader;
+    uintptr_t from = va & PAGE_MASK;
+    uintptr_t to = (va + length + PAGE_OFFSET_MASK) & PAGE_MASK;
+    bool found = false;
+    int32_t ret = 0;
+
+    for (mmap_area_t *area = task->mmaps; area; area = area->next)
+    {
+        uintptr_t start = from > area->start ? from : area->start;
+        uintptr_t end = to < area->end ? to : area->end;
+        if (start >= end)
+            continue;
+
+        found = true;
+        if (mmap_sync_range(task, area, start, end, false) < 0)
+            ret = -1;
+    }
+
+    return found ? ret : -1;
+}
+
+void mmap_unmap_all(struct PCB *task)
+{
+    while (task->mmaps)
+    {
+        if (mmap_release(task, &task->mmaps) < 0)
+            printk("Lost writes to a mapped file of %s\n", task->name);
+    }
+}
+
+int8_t mmap_copy(struct PCB *dst, struct PCB *src)
+{
+    mmap_area_t **tail = &dst->mmaps;
+
+    for (mmap_area_t *area = src->mmaps; area; area = area->next)
+    {
+        mmap_area_t *copy = slab_alloc(mmap_cache);
+        if (!copy)
+            return -1; // The caller unmaps what was copied so far
+
+        memcpy(copy, area, sizeof(mmap_area_t));
+        copy->next = NULL;
+        copy->fd = fat32_dup(area->fd);
+        if (copy->fd < 0)
+        {
+            slab_free(mmap_cache, copy);
+            return -1;
+        }
+
+        *tail = copy;
+        tail = &copy->next;
+    }
+
+    return 0;
+}
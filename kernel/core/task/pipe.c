@@ -0,0 +1,186 @@
+#include <kernel/core/task/pipe.h>
+#include <kernel/core/task/task.h>
+#include <kernel/core/task/uaccess.h>
+#include <kernel/arch/arm/svc.h>
+
+static slab_cache_t *pipe_cache = NULL;
+
+static void pipe_free(pipe_t *pipe)
+{
+    for (size_t i = 0; i < PIPE_MAX_PAGES; i++)
+    {
+        if (pipe->pages[i])
+            free_page(ALLOC_4K, pipe->pages[i]);
+    }
+
+    slab_free(pipe_cache, pipe);
+}
+
+// Every state change wakes every sleeper, each one restarts its call and checks again
+static void pipe_wake(pipe_t *pipe)
+{
+    struct PCB *task = pipe->waiters;
+    pipe->waiters = NULL;
+
+    while (task)
+    {
+        struct PCB *next = task->pipe_next;
+        task->pipe_wait = NULL;
+        task->pipe_next = NULL;
+        task_wake(task);
+        task = next;
+    }
+}
+
+pipe_t *pipe_create(uint32_t num_pages)
+{
+    if (num_pages == 0)
+        num_pages = 1;
+
+    if (num_pages > PIPE_MAX_PAGES || (num_pages & (num_pages - 1)))
+        return NULL; // Positions are reduced with a mask
+
+    if (!pipe_cache)
+        pipe_cache = create_slab_cache(sizeof(pipe_t));
+
+    if (!pipe_cache)
+        return NULL;
+
+    pipe_t *pipe = slab_alloc(pipe_cache);
+    if (!pipe)
+        return NULL;
+
+    memset(pipe, 0, sizeof(pipe_t));
+
+    for (uint32_t i = 0; i < num_pages; i++)
+    {
+        pipe->pages[i] = alloc_page(ALLOC_4K);
+        if (!pipe->pages[i])
+        {
+            pipe_free(pipe);
+            return NULL;
+        }
+    }
+
+    pipe->size = num_pages * SMALL_PAGE_SIZE;
+    pipe->readers = 1;
+    pipe->writers = 1;
+
+    return pipe;
+}
+
+void pipe_get(pipe_t *pipe, bool write_end)
+{
+    if (write_end)
+        pipe->writers++;
+    else
+        pipe->readers++;
+}
+
+void pipe_put(pipe_t *pipe, bool write_end)
+{
+    if (write_end)
+        pipe->writers--;
+    else
+        pipe->readers--;
+
+    // The other side sees the change: end of file for readers, a broken pipe for writers
+    pipe_wake(pipe);
+
+    if (pipe->readers == 0 && pipe->writers == 0)
+        pipe_free(pipe);
+}
+
+// Copies n bytes between buf and the ring at position pos, wrapping around the pages
+static void pipe_copy(pipe_t *pipe, uint32_t pos, uint8_t *buf, size_t n, bool to_pipe)
+{
+    while (n)
+    {
+        uint32_t offset = pos & (pipe->size - 1);
+        uint8_t *p = pipe->pages[offset / SMALL_PAGE_SIZE] + (offset & PAGE_OFFSET_MASK);
+        size_t chunk = SMALL_PAGE_SIZE - (offset & PAGE_OFFSET_MASK);
+        if (chunk > n)
+            chunk = n;
+
+        if (to_pipe)
+            memcpy(p, buf, chunk);
+        else
+            memcpy(buf, p, chunk);
+
+        pos += chunk;
+        buf += chunk;
+        n -= chunk;
+    }
+}
+
+int32_t pipe_read(pipe_t *pipe, void *buf, size_t n)
+{
+    uint32_t used = pipe->tail - pipe->head;
+    if (used == 0)
+        return pipe->writers ? PIPE_WOULD_BLOCK : 0;
+
+    if (n > used)
+        n = used;
+
+    // Fault in and unshare the buffer up front, the copy then cannot fail halfway
+    if (user_prepare_write(buf, n) < 0)
+        return -1;
+
+    pipe_copy(pipe, pipe->head, buf, n, false);
+    pipe->head += n;
+
+    pipe_wake(pipe);
+    return n;
+}
+
+int32_t pipe_write(pipe_t *pipe, const void *buf, size_t n)
+{
+    if (pipe->readers == 0)
+        return -1;
+
+    if (!user_range_ok(buf, n))
+        return -1;
+
+    uint32_t space = pipe->size - (pipe->tail - pipe->head);
+    if (space == 0 || (n <= PIPE_ATOMIC_MAX && space < n))
+        return PIPE_WOULD_BLOCK;
+
+    if (n > space)
+        n = space;
+
+    if (user_prepare_read(buf, n) < 0)
+        return -1;
+
+    pipe_copy(pipe, pipe->tail, (uint8_t *)buf, n, true);
+    pipe->tail += n;
+
+    pipe_wake(pipe);
+    return n;
+}
+
+int32_t pipe_sleep(pipe_t *pipe, struct regs *regs)
+{
+    current->pipe_wait = pipe;
+    current->pipe_next = pipe->waiters;
+    pipe->waiters = current;
+
+    current->state = BLOCKED;
+    regs->lr -= 4;
+    task_yield();
+    return regs->r0; // Arguments must be intact for the restarted call
+}
+
+void pipe_cancel(struct PCB *task)
+{
+    pipe_t *pipe = task->pipe_wait;
+
+    struct PCB **p = &pipe->waiters;
+    while (*p && *p != task)
+        p = &(*p)->pipe_next;
+
+    if (*p)
+        *p = task->pipe_next;
+
+    task->pipe_wait = NULL;
+    task->pipe_next = NULL;
+}
@@ -0,0 +1,220 @@
+#include <kernel/core/task/ring.h>
+#include <kernel/arch/arm/svc.h>
+
+static ring_ctx_t *rings = NULL; // Every ring, for the timer tick
+
+// The ring of the current task, seen through its own mapping
+#define RING ((ring_t *)TASK_RING_BASE)
+
+int32_t ring_setup(void)
+{
+    if (!current || current->kernel)
+        return -1;
+
+    struct PCB *task = current->leader;
+    if (task->ring)
+        return -1;
+
+    ring_ctx_t *ctx = kmalloc(sizeof(ring_ctx_t));
+    void *page = alloc_page(ALLOC_4K);
+    uint32_t *coarse_pt = get_coarse_table(task->pt, TASK_RING_BASE, DOMAIN_USER);
+    if (!ctx || !page || !coarse_pt)
+    {
+        kfree(ctx);
+        if (page)
+            free_page(ALLOC_4K, page);
+        return -1;
+    }
+
+    memset(ctx, 0, sizeof(ring_ctx_t));
+    memset(page, 0, SMALL_PAGE_SIZE);
+
+    // The kernel only touches the ring through this mapping, so the cache never sees an alias
+    map_page((uintptr_t)coarse_pt, TASK_RING_BASE, (uintptr_t)page, AP(AP_USER_RW));
+    tlb_invalidate_va(TASK_RING_BASE);
+
+    ctx->task = task;
+    ctx->next = rings;
+    rings = ctx;
+    task->ring = ctx;
+
+    return TASK_RING_BASE;
+}
+
+static void ring_complete(uint32_t user_data, int32_t res)
+{
+    ring_t *ring = RING;
+
+    if (ring->cq_tail - ring->cq_head >= RING_CQ_ENTRIES)
+    {
+        ring->cq_overflow++;
+        return;
+    }
+
+    ring_cqe_t *cqe = &ring->cqes[ring->cq_tail & (RING_CQ_ENTRIES - 1)];
+    cqe->user_data = user_data;
+    cqe->res = res;
+    ring->cq_tail++;
+}
+
+static int32_t ring_rw(const ring_sqe_t *sqe)
+{
+    void *buf = (void *)sqe->addr;
+
+    if (sqe->off >= 0 && file_lseek(sqe->fd, sqe->off, SEEK_SET) < 0)
+        return -1;
+
+    // Fault the buffer in now: this may run from the timer tick, where a bad address must not kill the task
+    if (sqe->op == RING_OP_READ)
+    {
+        if (sqe->len && user_prepare_write(buf, sqe->len) < 0)
+            return -1;
+
+        return file_read(sqe->fd, buf, sqe->len);
+    }
+
+    // The source of a write is only read, so it may live in a read-only segment
+    if (sqe->len && user_prepare_read(buf, sqe->len) < 0)
+        return -1;
+
+    return file_write(sqe->fd, buf, sqe->len);
+}
+
+// Runs the submissions and due timeouts of ctx, whose task is current
+static void ring_process(ring_ctx_t *ctx)
+{
+    ring_t *ring = RING;
+    uint64_t now = clock_us();
+
+    // The indices are written by user space: read them once and never run more than a full ring
+    uint32_t head = ring->sq_head;
+    uint32_t tail = ring->sq_tail;
+    if (tail - head > RING_SQ_ENTRIES)
+    {
+        ring->sq_head = tail;
+        ring_complete(0, -1);
+        head = tail;
+    }
+
+    for (; head != tail; head++)
+    {
+        ring_sqe_t sqe = ring->sqes[head & (RING_SQ_ENTRIES - 1)];
+        ring->sq_head = head + 1;
+
+        switch (sqe.op)
+        {
+        case RING_OP_NOP:
+            ring_complete(sqe.user_data, 0);
+            break;
+        case RING_OP_READ:
+        case RING_OP_WRITE:
+            ring_complete(sqe.user_data, ring_rw(&sqe));
+            break;
+        case RING_OP_TIMEOUT:
+            if (ctx->nr_timers == RING_MAX_TIMERS)
+            {
+                ring_complete(sqe.user_data, -2);
+                break;
+            }
+            ctx->timers[ctx->nr_timers].deadline_us = now + sqe.len;
+            ctx->timers[ctx->nr_timers].user_data = sqe.user_data;
+            ctx->nr_timers++;
+            break;
+        default:
+            ring_complete(sqe.user_data, -1);
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; i < ctx->nr_timers;)
+    {
+        if (ctx->timers[i].deadline_us > now)
+        {
+            i++;
+            continue;
+        }
+
+        ring_complete(ctx->timers[i].user_data, 0);
+        ctx->timers[i] = ctx->timers[--ctx->nr_timers];
+    }
+}
+
+int32_t ring_enter(struct regs *regs)
+{
+    ring_ctx_t *ctx = current ? current->leader->ring : NULL;
+    if (!ctx)
+        return -1;
+
+    if (ctx->waiter == current)
+        ctx->waiter = NULL;
+
+    ring_process(ctx);
+
+    ring_t *ring = RING;
+    if (ring->cq_tail == ring->cq_head && (regs->r0 & RING_ENTER_WAIT) && ctx->nr_timers)
+    {
+        // Block, and execute the svc again once the tick finds a timeout due
+        ctx->waiter = current;
+        current->state = BLOCKED;
+        regs->lr -= 4;
+        task_yield();
+        return regs->r0; // Arguments must be intact for the restarted call
+    }
+
+    return ring->cq_tail - ring->cq_head;
+}
+
+void ring_tick(bool user)
+{
+    uint64_t now = clock_us();
+
+    for (ring_ctx_t *ctx = rings; ctx; ctx = ctx->next)
+    {
+        if (!ctx->waiter)
+            continue;
+
+        for (uint32_t i = 0; i < ctx->nr_timers; i++)
+        {
+            if (ctx->timers[i].deadline_us <= now)
+            {
+                task_wake(ctx->waiter);
+                ctx->waiter = NULL;
+                break;
+            }
+        }
+    }
+
+    if (user && current && !current->kernel && current->leader->ring)
+        ring_process(current->leader->ring);
+}
+
+void ring_cancel(struct PCB *task)
+{
+    ring_ctx_t *ctx = task->leader->ring;
+    if (ctx && ctx->waiter == task)
+        ctx->waiter = NULL;
+}
+
+void ring_release(struct PCB *task)
+{
+    ring_ctx_t *ctx = task->ring;
+    if (!ctx)
+        return;
+
+    ring_ctx_t **p = &rings;
+    while (*p && *p != ctx)
+        p = &(*p)->next;
+    if (*p)
+        *p = ctx->next;
+
+    // Only regions are unmapped with the address space, so the ring page is dropped here
+    uint32_t entry = page_entry(task->pt, TASK_RING_BASE);
+    if (entry)
+    {
+        page_put(ALLOC_4K, (void *)COARSE_PAGE_BASE(entry));
+        ((uint32_t *)COARSE_BASE(task->pt[L1_INDEX(TASK_RING_BASE)]))[L2_INDEX(TASK_RING_BASE)] = 0;
+    }
+
+    kfree(ctx);
+    task->ring = NULL;
+}
@@ -0,0 +1,250 @@
+#include <kernel/core/task/shm.h>
+
+static shm_t *shm_list = NULL;
+static slab_cache_t *shm_cache = NULL;
+static slab_cache_t *shm_map_cache = NULL;
+
+static shm_t *shm_find(const char *name)
+{
+    for (shm_t *shm = shm_list; shm; shm = shm->next)
+    {
+        if (strcmp(shm->name, name) == 0)
+            return shm;
+    }
+
+    return NULL;
+}
+
+// Drops one attachment, freeing the object and its pages with the last one
+static void shm_put(shm_t *shm)
+{
+    if (shm->ref_count && --shm->ref_count)
+        return;
+
+    shm_t **p = &shm_list;
+    while (*p && *p != shm)
+        p = &(*p)->next;
+    if (*p)
+        *p = shm->next;
+
+    for (size_t i = 0; i < shm->num_pages; i++)
+    {
+        if (shm->pages[i])
+            page_put(ALLOC_4K, (void *)shm->pages[i]);
+    }
+
+    printk("Freed shared memory %s\n", shm->name);
+    kfree(shm->pages);
+    slab_free(shm_cache, shm);
+}
+
+static shm_t *shm_create(const char *name, size_t size)
+{
+    size_t num_pages = (size + PAGE_OFFSET_MASK) / SMALL_PAGE_SIZE;
+    if (!num_pages || num_pages > SHM_MAX_PAGES)
+        return NULL;
+
+    if (!shm_cache)
+        shm_cache = create_slab_cache(sizeof(shm_t));
+
+    shm_t *shm = shm_cache ? slab_alloc(shm_cache) : NULL;
+    if (!shm)
+        return NULL;
+
+    memset(shm, 0, sizeof(shm_t));
+    strcpy(shm->name, name);
+    shm->num_pages = num_pages;
+    shm->pages = kmalloc(num_pages * sizeof(uintptr_t));
+    if (!shm->pages)
+    {
+        slab_free(shm_cache, shm);
+        return NULL;
+    }
+
+    memset(shm->pages, 0, num_pages * sizeof(uintptr_t));
+
+    shm->next = shm_list;
+    shm_list = shm;
+
+    for (size_t i = 0; i < num_pages; i++)
+    {
+        void *page = alloc_page(ALLOC_4K);
+        if (!page)
+        {
+            shm_put(shm);
+            return NULL;
+        }
+
+        memset(page, 0, SMALL_PAGE_SIZE);
+        shm->pages[i] = (uintptr_t)page;
+    }
+
+    return shm;
+}
+
+// Removes the mappings of num_pages pages at va, dropping the task's references
+static void shm_unmap(struct PCB *task, uintptr_t va, size_t num_pages)
+{
+    for (size_t i = 0; i < num_pages; i++, va += SMALL_PAGE_SIZE)
+    {
+        uint32_t l1_entry = task->pt[L1_INDEX(va)];
+        if (!is_valid_l1_coarse_entry(l1_entry))
+            continue;
+
+        uint32_t *coarse_pt = (uint32_t *)COARSE_BASE(l1_entry);
+        uint32_t entry = coarse_pt[L2_INDEX(va)];
+        if (!is_valid_l2_coarse_entry(entry))
+            continue;
+
+        page_put(ALLOC_4K, (void *)COARSE_PAGE_BASE(entry));
+        coarse_pt[L2_INDEX(va)] = 0;
+        tlb_invalidate_va(va);
+    }
+}
+
+// First address of the shared memory window with num_pages free pages
+static uintptr_t shm_find_va(struct PCB *task, size_t num_pages)
+{
+    uintptr_t va = TASK_SHM_BASE;
+    size_t size = num_pages * SMALL_PAGE_SIZE;
+
+    while (va + size <= TASK_SHM_END)
+    {
+        shm_map_t *overlap = NULL;
+        for (shm_map_t *map = task->shm_maps; map && !overlap; map = map->next)
+        {
+            uintptr_t end = map->va + map->shm->num_pages * SMALL_PAGE_SIZE;
+            if (va < end && map->va < va + size)
+                overlap = map;
+        }
+
+        if (!overlap)
+            return va;
+
+        va = overlap->va + overlap->shm->num_pages * SMALL_PAGE_SIZE;
+    }
+
+    return 0;
+}
+
+int32_t shm_attach(const char *name, size_t size)
+{
+    char kname[SHM_NAME_MAX];
+    if (!current || current->kernel || strncpy_from_user(kname, name, sizeof(kname)) <= 0)
+        return -1;
+
+    struct PCB *task = current->leader;
+
+    shm_t *shm = shm_find(kname);
+    if (shm)
+    {
+        if (size > shm->num_pages * SMALL_PAGE_SIZE)
+            return -1;
+
+        for (shm_map_t *map = task->shm_maps; map; map = map->next)
+        {
+            // A second mapping in the same task would alias in the virtually indexed cache
+            if (map->shm == shm)
+                return map->va;
+        }
+    }
+    else
+    {
+        shm = shm_create(kname, size);
+        if (!shm)
+            return -1;
+    }
+
+    if (!shm_map_cache)
+        shm_map_cache = create_slab_cache(sizeof(shm_map_t));
+
+    uintptr_t va = shm_find_va(task, shm->num_pages);
+    shm_map_t *map = (va && shm_map_cache) ? slab_alloc(shm_map_cache) : NULL;
+    if (!map)
+        goto fail;
+
+    for (size_t i = 0; i < shm->num_pages; i++)
+    {
+        uintptr_t page_va = va + i * SMALL_PAGE_SIZE;
+        uint32_t *coarse_pt = get_coarse_table(task->pt, page_va, DOMAIN_USER);
+        if (!coarse_pt)
+        {
+            shm_unmap(task, va, i);
+            slab_free(shm_map_cache, map);
+            goto fail;
+        }
+
+        map_page((uintptr_t)coarse_pt, page_va, shm->pages[i], AP(AP_USER_RW));
+        page_get(ALLOC_4K, (void *)shm->pages[i]);
+    }
+
+    map->shm = shm;
+    map->va = va;
+    map->next = task->shm_maps;
+    task->shm_maps = map;
+    shm->ref_count++;
+
+    return va;
+
+fail:
+    if (!shm->ref_count)
+        shm_put(shm); // Created for this attach only
+    return -1;
+}
+
+// Unlinks and undoes one attachment of task
+static void shm_map_release(struct PCB *task, shm_map_t **p)
+{
+    shm_map_t *map = *p;
+    *p = map->next;
+
+    shm_unmap(task, map->va, map->shm->num_pages);
+    shm_put(map->shm);
+    slab_free(shm_map_cache, map);
+}
+
+int32_t shm_detach(uintptr_t va)
+{
+    if (!current)
+        return -1;
+
+    struct PCB *task = current->leader;
+    for (shm_map_t **p = &task->shm_maps; *p; p = &(*p)->next)
+    {
+        if ((*p)->va == va)
+        {
+            shm_map_release(task, p);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+void shm_detach_all(struct PCB *task)
+{
+    while (task->shm_maps)
+        shm_map_release(task, &task->shm_maps);
+}
+
+int8_t shm_copy(struct PCB *dst, struct PCB *src)
+{
+    shm_map_t **tail = &dst->shm_maps;
+
+    for (shm_map_t *map = src->shm_maps; map; map = map->next)
+    {
+        shm_map_t *copy = slab_alloc(shm_map_cache);
+        if (!copy)
+            return -1; // The caller detaches what was copied so far
+
+        copy->shm = map->shm;
+        copy->va = map->va;
+        copy->next = NULL;
+        map->shm->ref_count++;
+
+        *tail = copy;
+        tail = &copy->next;
+    }
+
+    return 0;
+}
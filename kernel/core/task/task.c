@@ -1,72 +1,611 @@
 #include <kernel/core/task/task.h>
+#include <kernel/arch/arm/svc.h>
+#include <kernel/arch/arm/cache.h>
+#include <kernel/hw/pic.h>
+#include <kernel/core/task/files.h>
+#include <kernel/core/task/shm.h>
+#include <kernel/core/task/futex.h>
+#include <kernel/core/task/ipc.h>
+#include <kernel/core/task/ring.h>
+#include <kernel/core/task/kdata.h>
+#include <kernel/core/task/pipe.h>
+#include <kernel/core/task/mmap.h>
 
 struct PCB *tasks = NULL;
 static size_t current_task = 0;
 static size_t total_tasks = 0;
+static uint32_t next_pid = 0;
 struct PCB *current = NULL;
 
 static slab_cache_t *pcb_cache = NULL;
-static l1_free_node_t *l1_free_list = NULL;
-static slab_cache_t *l1_free_cache = NULL;
+static size_t nr_linked = 0;         // Entries in the task list
+static uint32_t *active_pt = NULL;   // L1 table currently in TTBR
+static uint32_t rt_util = 0;         // CPU share reserved by admitted real-time tasks
+static struct PCB *idle_task = NULL; // Runs when nothing else is ready, never in the task list
+
+static slab_cache_t *exit_record_cache = NULL;
+
+static uint32_t sched_latency_hist[SCHED_LAT_BUCKETS];
+static uint32_t sched_latency_samples = 0;
+
+static struct PCB *kthread_alloc(void (*entry)(void), const char *name);
+
+static __attribute__((noreturn)) void idle_main(void)
+{
+    while (1)
+        wait_for_interrupt();
+}
 
 void task_init(void)
 {
     pcb_cache = create_slab_cache(sizeof(struct PCB));
-    l1_free_cache = create_slab_cache(sizeof(l1_free_node_t));
+
+    if (kdata_init() < 0)
+        printk("Failed to allocate the kernel data page\n");
+
+    idle_task = kthread_alloc(idle_main, "idle");
+    if (!idle_task)
+        printk("Failed to create the idle thread\n");
 }
 
-// Add an L1 table to the deferred free list
-static void add_to_l1_free_list(uint32_t *l1)
+// Returns the base of the stack slot containing va, or 0 if va is not in a slot in use
+static uintptr_t task_stack_slot_base(struct PCB *task, uintptr_t va)
 {
-    if (!l1)
-        return;
+    vm_region_t *region = vm_region_find(task->leader, va);
+    return region && region->type == VM_REGION_STACK ? region->start : 0;
+}
+
+int8_t task_stack_fault(struct PCB *task, uintptr_t va)
+{
+    uintptr_t base = task_stack_slot_base(task, va);
+    if (!base)
+        return -1; // Not a stack address
+
+    if (va < base + TASK_STACK_GUARD_SIZE)
+    {
+        printk("Stack overflow in task %s\n", task->name);
+        return -2;
+    }
+
+    uint32_t *coarse_pt = get_coarse_table(task->pt, va, DOMAIN_USER);
+    if (!coarse_pt)
+        return -3;
+
+    // Back the whole 64KB block with one large page if it is above the guard and still empty
+    uintptr_t block = va & LARGE_PAGE_MASK;
+    size_t first = L2_INDEX(block);
+    bool empty = block >= base + TASK_STACK_GUARD_SIZE;
+    for (size_t i = 0; empty && i < LARGE_PAGE_ENTRIES; i++)
+        empty = !is_valid_l2_coarse_entry(coarse_pt[first + i]);
+
+    void *large = empty ? alloc_pages(ALLOC_4K, LARGE_PAGE_ENTRIES) : NULL;
+    if (large)
+    {
+        memset(large, 0, LARGE_PAGE_SIZE);
+        for (size_t i = 0; i < LARGE_PAGE_ENTRIES; i++)
+            coarse_pt[first + i] = L2_LARGE_ENTRY((uintptr_t)large, AP(AP_USER_RW), C_WT, B_BUF);
+        return 0;
+    }
+
+    // Otherwise, or if no contiguous memory is left, fall back to a single small page
+    void *page = alloc_page(ALLOC_4K);
+    if (!page)
+        return -3;
+
+    memset(page, 0, SMALL_PAGE_SIZE);
+    coarse_pt[L2_INDEX(va)] = L2_PAGE_ENTRY((uintptr_t)page, AP(AP_USER_RW), C_WT, B_BUF);
 
-    if (!l1_free_cache)
-        l1_free_cache = create_slab_cache(sizeof(l1_free_node_t));
+    return 0;
+}
+
+int8_t task_page_fault(struct PCB *task, uintptr_t va)
+{
+    task = task->leader; // Threads fault on the regions of their leader
+
+    if (va >= TASK_MMAP_BASE && va < TASK_MMAP_END)
+        return mmap_fault(task, va);
+
+    vm_region_t *region = vm_region_find(task, va);
+    if (!region)
+        return -1;
 
-    l1_free_node_t *node = slab_alloc(l1_free_cache);
-    node->l1 = l1;
-    node->next = l1_free_list;
-    l1_free_list = node;
+    switch (region->type)
+    {
+    case VM_REGION_STACK:
+        return task_stack_fault(task, va);
+    case VM_REGION_SEGMENT:
+        return vm_region_fault(task, va);
+    default:
+        return -1; // Shared object pages are mapped when the object is attached
+    }
 }
 
-static void free_pending_l1_tables(void)
+bool task_va_writable(struct PCB *task, uintptr_t va)
 {
-    l1_free_node_t *node = l1_free_list;
+    vm_region_t *region = vm_region_find(task->leader, va);
+    if (!region)
+        return false;
 
-    while (node)
+    if (region->type == VM_REGION_STACK)
+        return va >= region->start + TASK_STACK_GUARD_SIZE;
+
+    if (region->type == VM_REGION_SO)
+        return true; // Shared object pages are mapped read-only and copied on the first write
+
+    return vm_region_writable(task->leader, va);
+}
+
+int8_t task_cow_fault(struct PCB *task, uintptr_t va)
+{
+    task = task->leader;
+
+    // File pages are shared, never copied: the first write only marks them dirty
+    if (va >= TASK_MMAP_BASE && va < TASK_MMAP_END)
+        return mmap_write_fault(task, va);
+
+    uint32_t entry = page_entry(task->pt, va);
+    if (!entry || L2_GET_AP(entry) != AP(AP_USER_READ))
+        return -1;
+
+    if (!task_va_writable(task, va))
+        return -1; // A genuine write to read-only memory
+
+    // Only this page changes: a large page or section around it becomes small pages
+    if (split_page_mapping(task->pt, va) < 0)
+        return -3;
+
+    uint32_t *coarse_pt = (uint32_t *)COARSE_BASE(task->pt[L1_INDEX(va)]);
+    entry = coarse_pt[L2_INDEX(va)];
+
+    void *page = (void *)COARSE_PAGE_BASE(entry);
+    if (page_ref_count(ALLOC_4K, page) > 1)
     {
-        // Free the physical memory of the L1 table
-        free_page(ALLOC_16K, node->l1);
+        // Still shared: give this task its own copy
+        void *copy = alloc_page(ALLOC_4K);
+        if (!copy)
+            return -3;
+
+        // The latest writes may sit in dirty lines under the user address; after the remap those lines would belong to the copy
+        dcache_flush_range(va & PAGE_MASK, SMALL_PAGE_SIZE);
+
+        memcpy(copy, page, SMALL_PAGE_SIZE);
+        page_put(ALLOC_4K, page);
+        entry = (entry & ~0xFFFFF000) | (uintptr_t)copy;
+    }
+
+    coarse_pt[L2_INDEX(va)] = L2_SET_AP(entry, AP(AP_USER_RW));
+    tlb_invalidate_va(va);
+
+    return 0;
+}
+
+// Unlink a task from the task list
+static void task_unlink(struct PCB *task)
+{
+    struct PCB **p = &tasks;
+    while (*p && *p != task)
+        p = &(*p)->next;
 
-        l1_free_node_t *next = node->next;
-        slab_free(l1_free_cache, node);
-        node = next;
+    if (*p)
+    {
+        *p = task->next;
+        nr_linked--;
     }
+}
 
-    l1_free_list = NULL;
+// Append a task to the end of the task list
+static void task_link(struct PCB *task)
+{
+    struct PCB **p = &tasks;
+    while (*p)
+        p = &(*p)->next;
+    *p = task;
+    task->next = NULL;
+    nr_linked++;
 }
 
-static void map_stack(uint32_t *pt)
+// Free the coarse tables of an address space whose pages were all unmapped already
+static void free_page_tables(uint32_t *pt)
 {
-    printk("Allocating pages and mapping stack...\n");
-    const size_t num_pages = TASK_STACK_SIZE / SMALL_PAGE_SIZE;
-    uint32_t *coarse_pt;
-    for (size_t i = 0; i < num_pages; i++)
+    // Coarse tables only ever cover user addresses
+    for (size_t i = L1_INDEX(USER_SPACE_START); i < L1_INDEX(USER_SPACE_END); i++)
     {
-        uintptr_t va = TASK_STACK_BASE + i * SMALL_PAGE_SIZE; // Compute virtual address
+        if (is_valid_l1_coarse_entry(pt[i]))
+            free_page(ALLOC_1K, (void *)COARSE_BASE(pt[i]));
+
+        pt[i] = 0;
+    }
+}
+
+// Records a thread's stack slot as a region of its leader
+static int8_t add_stack_slot(struct PCB *leader, uint8_t slot)
+{
+    uintptr_t base = TASK_STACK_BASE + slot * TASK_STACK_SIZE;
+    if (!vm_region_insert(leader, base, base + TASK_STACK_SIZE, AP_USER_RW, VM_REGION_STACK))
+        return -1;
 
-        if (i % NUM_COARSE_ENTRIES == 0) // Check if new coarse page table is needed
+    leader->stack_slots |= 1u << slot;
+    return 0;
+}
+
+// Drop the pages of a thread's stack slot and hand the slot back to its leader
+static void free_stack_slot(struct PCB *leader, uint8_t slot)
+{
+    vm_region_t *region = vm_region_find(leader, TASK_STACK_BASE + slot * TASK_STACK_SIZE);
+    if (region && region->type == VM_REGION_STACK)
+        vm_region_remove(leader, region);
+
+    leader->stack_slots &= ~(1u << slot);
+}
+
+// Release everything a task owns except its PCB and L1 table
+static void task_release(struct PCB *task)
+{
+    kfree(task->elf_info.strtab);
+    kfree(task->elf_info.symtab);
+    kfree(task->elf_info.hash.bucket);
+    kfree(task->elf_info.hash.chain);
+
+    unload_shared_objects(task);
+    image_put(task->image);
+    task->image = NULL;
+
+    vm_region_remove_all(task, VM_REGION_ALL); // Drops every page of the segments, stacks and shared objects
+    fat32_close(task->fd);
+    files_close_all(task);
+    shm_detach_all(task);
+    ipc_release_ports(task);
+    ring_release(task);
+    mmap_unmap_all(task);
+
+    free_page_tables(task->pt);
+}
+
+/*
+ * Share every user page of src with dst. Writable pages are made read-only in
+ * both tables so that the first write from either task faults and is copied by
+ * task_cow_fault(). Kernel sections are already present from init_page_table().
+ */
+static int8_t copy_page_tables(uint32_t *dst, uint32_t *src)
+{
+    for (size_t i = 0; i < NUM_L1_ENTRIES; i++)
+    {
+        uint32_t l1_entry = src[i];
+        if (is_user_section_entry(l1_entry))
         {
-            // Allocate coarse page table and set l1 entry
-            coarse_pt = (uint32_t *)alloc_page(ALLOC_1K);
-            pt[L1_INDEX(va)] = COARSE_ENTRY((uintptr_t)coarse_pt, DOMAIN_USER);
+            // Sections only back program segments, which are never shared memory
+            if (SECTION_GET_AP(l1_entry) == AP_USER_RW)
+            {
+                dcache_clean_range(i << 20, SECTION_SIZE); // The child reads these pages through its own mapping
+                l1_entry = SECTION_SET_AP(l1_entry, AP_USER_READ);
+                src[i] = l1_entry;
+            }
+
+            for (size_t j = 0; j < NUM_COARSE_ENTRIES; j++)
+                page_get(ALLOC_4K, (void *)((l1_entry & SECTION_MASK) + j * SMALL_PAGE_SIZE));
+
+            dst[i] = l1_entry;
+            continue;
         }
 
-        uintptr_t page_phys = (uintptr_t)alloc_page(ALLOC_4K);                // Allocate new page
-        coarse_pt[i] = L2_PAGE_ENTRY(page_phys, AP(AP_USER_RW), C_WT, B_BUF); // Set coarse entry
+        if (!is_valid_l1_coarse_entry(l1_entry))
+            continue;
+
+        uint32_t *src_pt = (uint32_t *)COARSE_BASE(l1_entry);
+        uint32_t *dst_pt = get_coarse_table(dst, i << 20, L1_DOMAIN(l1_entry));
+        if (!dst_pt)
+            return -1;
+
+        for (size_t j = 0; j < NUM_COARSE_ENTRIES; j++)
+        {
+            uint32_t entry = src_pt[j];
+            if (!is_valid_l2_coarse_entry(entry))
+                continue;
+
+            // Shared memory stays shared: both tasks keep writing to the same pages
+            uintptr_t va = (i << 20) | (j << 12);
+            bool shared = va >= TASK_SHM_BASE && va < TASK_SHM_END;
+            bool file = va >= TASK_MMAP_BASE && va < TASK_MMAP_END;
+
+            if (va == TASK_RING_BASE)
+                continue; // The ring belongs to the parent, the child sets up its own
+
+            if (kdata_va(va))
+                continue; // Mapped by kdata_map() like in every task
+
+            if (L2_GET_AP(entry) == AP(AP_USER_RW) && !shared && !file)
+            {
+                dcache_clean_range(va, SMALL_PAGE_SIZE); // The child reads this page through its own mapping
+                entry = L2_SET_AP(entry, AP(AP_USER_READ));
+                src_pt[j] = entry;
+            }
+
+            page_get(ALLOC_4K, (void *)l2_page_base(entry, va));
+
+            // File pages stay shared too, but the child's first write must mark them dirty itself
+            dst_pt[j] = file ? L2_SET_AP(entry, AP(AP_USER_READ)) : entry;
+        }
+    }
+
+    // src is the live page table: drop any cached writable translations
+    tlb_invalidate_all();
+
+    return 0;
+}
+
+int32_t task_fork(struct regs *regs)
+{
+    if (!current || total_tasks >= MAX_TASKS)
+        return -1;
+
+    // The address space belongs to the leader, only the calling thread is duplicated
+    struct PCB *parent = current->leader;
+
+    struct PCB *child = slab_alloc(pcb_cache);
+    if (!child)
+        return -1;
+
+    memcpy(child, parent, sizeof(struct PCB));
+    child->leader = child;
+    child->threads = 1;
+    child->stack_slot = current->stack_slot;
+    child->stack_slots = 1u << current->stack_slot;
+    child->shared_objs = NULL;
+    child->regions = NULL;
+    child->shm_maps = NULL;
+    child->mmaps = NULL;
+    child->futex_key = 0; // The leader may be waiting if another thread forks
+    child->ipc_send = NULL;
+    child->ring = NULL;
+    child->pipe_wait = NULL;
+    child->pipe_next = NULL;
+
+    // Dynamic tables are only used while loading, the child never needs them
+    child->elf_info.strtab = NULL;
+    child->elf_info.symtab = NULL;
+    child->elf_info.hash.bucket = NULL;
+    child->elf_info.hash.chain = NULL;
+
+    child->fd = fat32_dup(parent->fd);
+    child->parent = parent;
+    memset(&child->rt, 0, sizeof(task_rt_t)); // Reservations are not inherited
+    child->children = 0;
+    child->exited = NULL;
+    image_get(child->image);
+
+    // Without its own descriptor the child would demand-page its segments as zeros
+    if (parent->fd >= 0 && child->fd < 0)
+    {
+        image_put(child->image);
+        slab_free(pcb_cache, child);
+        return -1;
+    }
+
+    child->pt = (uint32_t *)alloc_page(ALLOC_16K);
+    if (!child->pt)
+    {
+        image_put(child->image);
+        fat32_close(child->fd);
+        slab_free(pcb_cache, child);
+        return -1;
+    }
+
+    init_page_table(child->pt);
+
+    if (files_copy(child, parent) < 0 || vm_region_copy_all(child, parent) < 0 ||
+        copy_shared_objects(child, parent) < 0 || shm_copy(child, parent) < 0 ||
+        mmap_copy(child, parent) < 0 || kdata_map(child->pt) < 0 ||
+        copy_page_tables(child->pt, parent->pt) < 0)
+    {
+        task_release(child);
+        free_page(ALLOC_16K, child->pt);
+        slab_free(pcb_cache, child);
+        return -1;
+    }
+
+    // Demand-paged file regions read through the child's own descriptor
+    for (vm_region_t *r = child->regions; r; r = r->next)
+    {
+        if (r->type == VM_REGION_SEGMENT)
+            r->fd = child->fd;
+    }
+
+    // Only the forking thread exists in the child: drop the stacks of the others
+    for (vm_region_t *r = child->regions, *next; r; r = next)
+    {
+        next = r->next;
+        if (r->type == VM_REGION_STACK && r->start != TASK_STACK_BASE + child->stack_slot * TASK_STACK_SIZE)
+            vm_region_remove(child, r);
+    }
+
+    // The user mode SP and LR are banked, read them from the parent's user registers
+    uint32_t user_regs[2];
+    asm volatile("stmia %0, {sp, lr}^" : : "r"(user_regs) : "memory");
+
+    child->context[CTX_SP] = user_regs[0];
+    child->context[CTX_LR] = user_regs[1];
+    child->context[CTX_SPSR] = regs->spsr;
+    for (size_t i = 0; i < 13; i++)
+        child->context[CTX_R0 + i] = ((uint32_t *)&regs->r0)[i];
+    child->context[CTX_R0] = 0; // fork() returns 0 in the child
+    child->context[CTX_PC] = regs->lr;
+
+    child->pid = next_pid++;
+    child->state = READY;
+    parent->children++;
+    memset(&child->stats, 0, sizeof(task_stats_t));
+    memset(&child->syscalls, 0, sizeof(syscall_stat_t));
+    child->stats.stamp_us = clock_us();
+    task_link(child);
+    total_tasks++;
+
+    printk("Forked task %s (pid %u -> %u)\n", child->name, parent->pid, child->pid);
+
+    return child->pid;
+}
+
+int32_t task_clone(struct regs *regs)
+{
+    struct PCB *leader = current ? current->leader : NULL;
+
+    if (!leader || leader->kernel)
+        return -1;
+
+    uint8_t slot = 0;
+    while (slot < TASK_MAX_THREADS && (leader->stack_slots & (1u << slot)))
+        slot++;
+
+    if (slot == TASK_MAX_THREADS)
+        return -1; // Every stack slot is taken
+
+    struct PCB *thread = slab_alloc(pcb_cache);
+    if (!thread)
+        return -1;
+
+    if (add_stack_slot(leader, slot) < 0)
+    {
+        slab_free(pcb_cache, thread);
+        return -1;
+    }
+
+    memset(thread, 0, sizeof(struct PCB));
+    strncpy(thread->name, leader->name, 11);
+    thread->pt = leader->pt;
+    thread->fd = -1;
+    thread->leader = leader;
+    thread->stack_slot = slot;
+    thread->sp = TASK_STACK_BASE + (slot + 1) * TASK_STACK_SIZE;
+
+    // The user trampoline receives the thread function and its argument
+    thread->context[CTX_PC] = regs->r0;
+    thread->context[CTX_R0] = regs->r1;
+    thread->context[CTX_R0 + 1] = regs->r2;
+    thread->context[CTX_SPSR] = 0x10; // SPSR: user mode, IRQ enabled
+    thread->context[CTX_SP] = (uint32_t)thread->sp;
+    thread->context[CTX_LR] = 0;
+
+    leader->threads++;
+
+    thread->pid = next_pid++;
+    thread->state = READY;
+    thread->stats.stamp_us = clock_us();
+    task_link(thread);
+
+    printk("Created thread %u of task %s (slot %u)\n", thread->pid, leader->name, slot);
+
+    return thread->pid;
+}
+
+/*
+ * Frees a terminated task or kernel thread. Runs on the worker thread, which
+ * uses the kernel page table, so the tables being freed are never active.
+ */
+static void task_reap(void *arg)
+{
+    struct PCB *task = arg;
+
+    struct PCB *leader = task->leader;
+
+    if (task->kernel)
+    {
+        kfree(task->kstack);
+        slab_free(pcb_cache, task);
+        return;
+    }
+
+    if (task != leader)
+    {
+        free_stack_slot(leader, task->stack_slot);
+        slab_free(pcb_cache, task);
+    }
+
+    // The address space lives until the last thread of the task is gone
+    if (--leader->threads)
+        return;
+
+    task_release(leader);
+    free_page(ALLOC_16K, leader->pt);
+    printk("Freed address space of task %s\n", leader->name);
+
+    slab_free(pcb_cache, leader);
+}
+
+static __attribute__((noreturn)) void kthread_exit(void)
+{
+    sei(); // Disable interrupts
+
+    current->state = TERMINATED;
+    task_unlink(current);
+
+    if (queue_work(task_reap, current) < 0)
+        printk("Leaking kernel thread %s\n", current->name);
+
+    task_yield();
+    cli(); // Enable interrupts, the software interrupt switches away
+    while (1)
+        ;
+}
+
+static struct PCB *kthread_alloc(void (*entry)(void), const char *name)
+{
+    if (!pcb_cache)
+        return NULL;
+
+    struct PCB *thread = slab_alloc(pcb_cache);
+    if (!thread)
+        return NULL;
+
+    memset(thread, 0, sizeof(struct PCB));
+
+    thread->kstack = kmalloc(KTHREAD_STACK_SIZE);
+    if (!thread->kstack)
+    {
+        slab_free(pcb_cache, thread);
+        return NULL;
     }
-    printk("Done\n");
+
+    strncpy(thread->name, name, 11);
+    thread->kernel = true;
+    thread->leader = thread;
+    thread->threads = 1;
+    thread->fd = -1;
+    thread->pt = (uint32_t *)l1_page_table;
+    thread->sp = (uintptr_t)thread->kstack + KTHREAD_STACK_SIZE;
+
+    thread->context[CTX_PC] = (uint32_t)entry;
+    thread->context[CTX_SPSR] = 0x1F; // SPSR: system mode, IRQ enabled
+    thread->context[CTX_SP] = (uint32_t)thread->sp;
+    thread->context[CTX_LR] = (uint32_t)kthread_exit;
+
+    thread->pid = next_pid++;
+    thread->state = READY;
+    thread->stats.stamp_us = clock_us();
+
+    return thread;
+}
+
+struct PCB *kthread_create(void (*entry)(void), const char *name)
+{
+    struct PCB *thread = kthread_alloc(entry, name);
+    if (!thread)
+        return NULL;
+
+    task_link(thread);
+
+    return thread;
+}
+
+// Undo a task_create() that failed after the task was linked
+static int8_t task_create_abort(struct PCB *task)
+{
+    task_unlink(task);
+    if (task->pt)
+    {
+        task_release(task);
+        free_page(ALLOC_16K, task->pt);
+    }
+    slab_free(pcb_cache, task);
+    return -1;
 }
 
 int8_t task_create(const char *path, const char *name)
@@ -80,101 +619,208 @@ int8_t task_create(const char *path, const char *name)
     if (!task)
         return -1; // Failed to allocate slab
 
+    // Not runnable until it is fully set up (a recycled PCB may hold any state)
+    task->state = BLOCKED;
+
     // Add task struct to the end of the linked list
-    struct PCB **p = &tasks;
-    while (*p)
-        p = &(*p)->next;
-    *p = task;
-    task->next = NULL;
+    task_link(task);
 
     // Copy task name into the struct
     strncpy(task->name, name, 11);
 
     task->elf_info.base_va = TASK_TEXT_BASE;
     task->elf_info.next_so_base = TASK_SO_BASE;
+    task->elf_info.strtab = NULL;
+    task->elf_info.symtab = NULL;
+    task->elf_info.hash.bucket = NULL;
+    task->elf_info.hash.chain = NULL;
+    task->fd = -1;
     task->shared_objs = NULL;
+    task->regions = NULL;
+    task->image = NULL;
+    task->shm_maps = NULL;
+    task->mmaps = NULL;
+    task->futex_key = 0;
+    task->ipc_send = NULL;
+    task->ring = NULL;
+    task->pipe_wait = NULL;
+    task->pipe_next = NULL;
+    task->kernel = false;
+    task->kstack = NULL;
+    task->parent = NULL;
+    task->children = 0;
+    task->exited = NULL;
+    task->leader = task;
+    task->threads = 1;
+    task->stack_slots = 0;
+    task->stack_slot = 0; // The main thread runs on slot 0
+    files_init(task);
 
     // Allocate L1 page table
     task->pt = (uint32_t *)alloc_page(ALLOC_16K);
+    if (!task->pt)
+        return task_create_abort(task);
 
     printk("task page table: %p\n", task->pt);
 
     // Initialize the task's page table
     init_page_table(task->pt);
 
-    // Map the stack
-    map_stack(task->pt);
+    if (kdata_map(task->pt) < 0)
+        return task_create_abort(task);
+
+    // Stack pages are mapped on first touch by task_stack_fault()
+    if (add_stack_slot(task, 0) < 0)
+        return task_create_abort(task);
 
     // Load the elf file
     uintptr_t entry = elf_load(path, task);
 
     if (!entry)
-        return -1;
+        return task_create_abort(task);
 
     task->sp = TASK_STACK_BASE + TASK_STACK_SIZE - 1024;
     printk("Stack top: %p", task->sp);
     printk("\n");
 
-    task->context[0] = (uint32_t)entry; // LR (will become PC on return)
-    for (int i = 1; i <= 13; i++)
+    task->context[CTX_PC] = (uint32_t)entry; // Becomes PC on return
+    for (int i = 0; i < 13; i++)
     { // r0-r12
-        task->context[i] = 0;
+        task->context[CTX_R0 + i] = 0;
     }
-    task->context[14] = 0x10;                // SPSR: user/system mode, IRQ enabled
-    task->context[15] = (uint32_t)task->sp;  // Original SP
-    task->context[16] = (uint32_t)task_exit; // Original LR
+    task->context[CTX_SPSR] = 0x10;              // SPSR: user mode, IRQ enabled
+    task->context[CTX_SP] = (uint32_t)task->sp;  // Original SP
+    task->context[CTX_LR] = (uint32_t)task_exit; // Original LR
 
     task->state = READY;
 
-    // TODO change this logic. Doesn't produce unique IDs
-    task->pid = total_tasks++;
+    task->pid = next_pid++;
+    total_tasks++;
 
-    printk("entry: %p\n", task->context[0]);
-    printk("task->sp: %p\n", task->context[15]);
-    printk("task_exit: %p\n", task->context[16]);
+    memset(&task->stats, 0, sizeof(task_stats_t));
+    memset(&task->syscalls, 0, sizeof(syscall_stat_t));
+    task->stats.stamp_us = clock_us();
+
+    printk("entry: %p\n", task->context[CTX_PC]);
+    printk("task->sp: %p\n", task->context[CTX_SP]);
+    printk("task_exit: %p\n", task->context[CTX_LR]);
     return 0;
 }
 
-__attribute__((noreturn)) void task_exit(int32_t status)
+// Hand the exit status of task to its parent, waking the parent if it waits
+static void task_notify_parent(struct PCB *task, int32_t status)
 {
-    current->state = TERMINATED;
+    struct PCB *parent = task->parent;
+    if (!parent)
+        return;
 
-    printk("Task exiting with exit code: %d\n", status);
+    parent->children--;
 
-    // Free all parts that were dynamically allocated by elf_load
-    kfree(current->elf_info.strtab);
-    kfree(current->elf_info.symtab);
-    kfree(current->elf_info.hash.bucket);
-    kfree(current->elf_info.hash.chain);
+    if (!exit_record_cache)
+        exit_record_cache = create_slab_cache(sizeof(exit_record_t));
 
-    unload_shared_objects(current);
+    exit_record_t *record = exit_record_cache ? slab_alloc(exit_record_cache) : NULL;
+    if (record)
+    {
+        record->pid = task->pid;
+        record->status = status;
+        record->next = NULL;
 
-    for (size_t i = 0; i < NUM_L1_ENTRIES; i++)
+        exit_record_t **tail = &parent->exited;
+        while (*tail)
+            tail = &(*tail)->next;
+        *tail = record;
+    }
+
+    // Blocking syscalls restart when woken, so a spurious wakeup is harmless
+    for (struct PCB *t = tasks; t; t = t->next)
     {
-        uint32_t l1_entry = current->pt[i];
-        if (!is_valid_l1_coarse_entry(l1_entry))
-            continue;
+        if (t->leader == parent)
+            task_wake(t);
+    }
+}
 
-        uint32_t *coarse_pt = COARSE_BASE(l1_entry);
-        for (size_t j = 0; j < NUM_COARSE_ENTRIES; j++)
-        {
-            uint32_t coarse_entry = coarse_pt[j];
-            if (!is_valid_l2_coarse_entry(coarse_entry))
-                continue;
+// Detach the children of an exiting task and drop the statuses nobody will wait for
+static void task_orphan_children(struct PCB *task)
+{
+    for (struct PCB *t = tasks; t; t = t->next)
+    {
+        if (t->parent == task)
+            t->parent = NULL;
+    }
 
-            free_page(ALLOC_4K, COARSE_PAGE_BASE(coarse_entry));
-        }
+    exit_record_t *record = task->exited;
+    while (record)
+    {
+        exit_record_t *next = record->next;
+        slab_free(exit_record_cache, record);
+        record = next;
+    }
+
+    task->exited = NULL;
+}
+
+void task_yield(void)
+{
+    pic->INT_SOFTSET = PIC_SOFTINT;
+}
+
+int32_t task_wait(struct regs *regs)
+{
+    struct PCB *task = current->leader; // Children belong to the task, not to a thread
+    exit_record_t *record = task->exited;
+
+    if (!record)
+    {
+        if (!task->children)
+            return -1;
+
+        // Block, and execute the svc again once a child has exited
+        current->state = BLOCKED;
+        regs->lr -= 4;
+        task_yield();
+        return regs->r0; // Arguments must be intact for the restarted call
+    }
+
+    int32_t *status = (int32_t *)regs->r0;
+    if (status && copy_to_user(status, &record->status, sizeof(int32_t)) < 0)
+        return -1;
+
+    int32_t pid = record->pid;
+    task->exited = record->next;
+    slab_free(exit_record_cache, record);
+
+    return pid;
+}
+
+__attribute__((noreturn)) void task_exit(int32_t status)
+{
+    sei(); // Disable interrupts
+
+    current->state = TERMINATED;
+
+    printk("Task exiting with exit code: %d\n", status);
+
+    sched_set_rt(current, 0, 0, 0); // Give back the CPU share reserved by the task
+    ipc_cancel(current);
+    ring_cancel(current);
 
-        free_page(ALLOC_1K, coarse_pt);
+    // Only the leader stands for the task towards its parent and children
+    if (current->leader == current)
+    {
+        task_notify_parent(current, status);
+        task_orphan_children(current);
+        total_tasks--;
     }
 
-    printk("Freed all pages in l1 page table @ %p\n", current->pt);
+    task_unlink(current);
 
-    add_to_l1_free_list(current->pt);
-    slab_free(pcb_cache, current);
+    // The address space is torn down by the worker once this task is switched out
+    if (queue_work(task_reap, current) < 0)
+        printk("Leaking task %s\n", current->name);
 
-    total_tasks--;
-    cli(); // Enable interrupts
+    task_yield();
+    cli(); // Enable interrupts, the software interrupt switches away
     while (1)
         ;
 }
@@ -183,6 +829,12 @@ static inline void set_page_table(uint32_t *l1_table)
 {
     uint32_t ttbr = (uint32_t)l1_table;
 
+    /* Both caches are virtually indexed and tagged and every task uses the same
+       user addresses (stacks are cacheable), so nothing of the previous task
+       may stay cached. The D-cache is written back while its mappings still
+       hold. */
+    dcache_flush_all();
+
     /* Write TTBR0 */
     asm volatile(
         "mcr p15, 0, %0, c2, c0, 0\n" /* TTBR <- ttbr */
@@ -198,52 +850,282 @@ static inline void set_page_table(uint32_t *l1_table)
         :
         : "r0", "memory");
 
-    /* Invalidate instruction & data caches if you rely on them
-       (optional; can be omitted if your system doesn't require it
-       or if caches are coherent/managed elsewhere). */
-    asm volatile(
-        "mov r0, #0\n"
-        "mcr p15, 0, r0, c7, c5, 0\n"  /* I-pcb_cache invalidate (IC ICIALL) */
-        "mcr p15, 0, r0, c7, c10, 4\n" /* D-pcb_cache clean/invalidate (implementation-dependent) */
-        :
-        :
-        : "r0", "memory");
+    /* Code written by the loader is synchronised where it is written (cache_sync_code()) */
+    icache_invalidate_all();
+    cache_drain_write_buffer();
 
     /* A small barrier: a few no-ops / dummy read to help ordering on older cores */
     asm volatile("nop\nnop\n" : : : "memory");
 }
 
-void scheduler(void)
+void task_wake(struct PCB *task)
+{
+    if (task->state != BLOCKED)
+        return;
+
+    // Any other wakeup ends a futex wait early, which callers must tolerate anyway
+    if (task->futex_key)
+        futex_cancel(task);
+
+    if (task->ipc_send)
+        ipc_cancel(task);
+
+    if (task->pipe_wait)
+        pipe_cancel(task);
+
+    task->state = READY;
+    task->stats.stamp_us = clock_us();
+}
+
+// Charge the time since the last stamp to a task leaving the CPU
+static void account_run(struct PCB *task, uint64_t now)
 {
-    printk("Scheduler\n");
+    uint64_t ran = now - task->stats.stamp_us;
 
-    if (total_tasks == 0)
+    task->stats.runtime_us += ran;
+    task->stats.stamp_us = now;
+
+    if (!task->rt.period_us)
+        return;
+
+    task->rt.budget_us -= ran;
+    if (task->rt.budget_us <= 0 && !task->rt.throttled && !task->rt.done)
+    {
+        task->rt.throttled = true; // Not picked again before its next period
+        task->rt.overruns++;
+    }
+}
+
+// Charge the time a task spent ready and record its wakeup-to-run latency
+static void account_wait(struct PCB *task, uint64_t now)
+{
+    uint64_t wait = now - task->stats.stamp_us;
+
+    task->stats.wait_us += wait;
+    task->stats.switches++;
+    task->stats.stamp_us = now;
+    if (wait > task->stats.max_wait_us)
+        task->stats.max_wait_us = wait > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)wait;
+
+    size_t bucket = 0;
+    while (bucket < SCHED_LAT_BUCKETS - 1 && (wait >> (bucket + 1)))
+        bucket++;
+
+    sched_latency_hist[bucket]++;
+    sched_latency_samples++;
+}
+
+// Start a new job of a real-time task at time start
+static void rt_release_job(task_rt_t *rt, uint64_t start)
+{
+    rt->period_end = start + rt->period_us;
+    rt->deadline = start + rt->deadline_us;
+    rt->budget_us = rt->runtime_us;
+    rt->done = false;
+    rt->throttled = false;
+    rt->missed = false;
+}
+
+// Count a missed deadline, and release the next job once the period is over
+static void rt_update(task_rt_t *rt, uint64_t now)
+{
+    if (!rt->done && !rt->missed && now > rt->deadline)
+    {
+        rt->misses++;
+        rt->missed = true;
+    }
+
+    if (now < rt->period_end)
+        return;
+
+    // Keep the phase of the task, skipping periods that passed entirely
+    uint64_t start = rt->period_end;
+    start += (now - start) / rt->period_us * rt->period_us;
+    rt_release_job(rt, start);
+}
+
+int8_t sched_set_rt(struct PCB *task, uint32_t period_us, uint32_t runtime_us, uint32_t deadline_us)
+{
+    if (!deadline_us)
+        deadline_us = period_us;
+
+    uint32_t util = 0;
+    if (period_us)
+    {
+        if (!runtime_us || runtime_us > deadline_us || deadline_us > period_us)
+            return -1;
+
+        // Density runtime/deadline: a sufficient test when deadlines are shorter than periods
+        util = (uint64_t)runtime_us * RT_UTIL_SCALE / deadline_us;
+    }
+
+    uint32_t irq = irq_save();
+
+    uint32_t total = rt_util - task->rt.util + util;
+    if (total > RT_UTIL_MAX)
+    {
+        irq_restore(irq);
+        return -2; // Not admitted, the task keeps its current class
+    }
+
+    rt_util = total;
+    memset(&task->rt, 0, sizeof(task_rt_t));
+    task->rt.period_us = period_us;
+    task->rt.runtime_us = runtime_us;
+    task->rt.deadline_us = deadline_us;
+    task->rt.util = util;
+    if (period_us)
+        rt_release_job(&task->rt, clock_us());
+
+    irq_restore(irq);
+
+    return 0;
+}
+
+void sched_yield(void)
+{
+    if (current && current->rt.period_us)
+        current->rt.done = true; // The job is over until the next period
+
+    task_yield();
+}
+
+// Earliest deadline first among the real-time tasks that may run, or NULL
+static struct PCB *rt_pick(uint64_t now)
+{
+    struct PCB *best = NULL;
+
+    for (struct PCB *t = tasks; t; t = t->next)
+    {
+        if (!t->rt.period_us)
+            continue;
+
+        rt_update(&t->rt, now);
+
+        bool runnable = t->state == READY || (t == current && t->state == RUNNING);
+        if (!runnable || t->rt.done || t->rt.throttled)
+            continue;
+
+        if (!best || t->rt.deadline < best->rt.deadline)
+            best = t;
+    }
+
+    return best;
+}
+
+void scheduler(void)
+{
+    if (!tasks && !idle_task)
     {
         printk("No tasks...\n");
         while (1)
             ;
     }
 
-    struct PCB *next = current ? current : tasks;
-    for (size_t i = 0; i < total_tasks; ++i)
-    {
-        next = next->next ? next->next : tasks;
-        if (next->state == READY)
-            break;
-    }
+    // Charge the running task first, a real-time one may just have used up its budget
+    uint64_t now = clock_us();
+    if (current)
+        account_run(current, now);
 
-    if (next == current || next->state != READY)
+    // Real-time tasks run ahead of everything else
+    struct PCB *next = rt_pick(now);
+    if (next && next == current)
         return;
 
-    if (current->state != TERMINATED)
+    if (!next)
+    {
+        // Round-robin over best-effort tasks. A terminated task is no longer in the list, so start from the head
+        next = (current && current != idle_task && current->state != TERMINATED) ? current : NULL;
+        for (size_t i = 0; i < nr_linked; ++i)
+        {
+            next = (next && next->next) ? next->next : tasks;
+            if (next->state == READY && !next->rt.period_us)
+                break;
+        }
+
+        if (!next || next->state != READY || next->rt.period_us)
+        {
+            if (current && current->state == RUNNING && !current->rt.period_us)
+                return; // Nothing else is ready, keep running
+
+            next = idle_task;
+        }
+
+        if (!next || next == current)
+            return;
+    }
+
+    if (current && current->state == RUNNING)
         current->state = READY;
 
+    account_wait(next, now);
+
     current = next;
     current->state = RUNNING;
+    kdata_switch(current, total_tasks);
+
+    // Threads of one task share their page table: no TLB flush between them
+    if (current->pt != active_pt)
+    {
+        set_page_table(current->pt);
+        active_pt = current->pt;
+    }
+}
+
+int8_t sched_task_info(uint32_t index, sched_task_info_t *out)
+{
+    struct PCB *task = tasks;
+    while (task && index > 0)
+    {
+        task = task->next;
+        index--;
+    }
+
+    if (!task)
+    {
+        if (index != 0 || !idle_task)
+            return -1;
+        task = idle_task;
+    }
+
+    memset(out, 0, sizeof(sched_task_info_t));
+    out->pid = task->pid;
+    strncpy(out->name, task->name, sizeof(task->name));
+    out->state = task->state;
+    out->switches = task->stats.switches;
+    out->runtime_us = task->stats.runtime_us;
+    out->wait_us = task->stats.wait_us;
+    out->max_wait_us = task->stats.max_wait_us;
+    out->kernel = task->kernel;
+    out->rt_period_us = task->rt.period_us;
+    out->rt_runtime_us = task->rt.runtime_us;
+    out->rt_deadline_us = task->rt.deadline_us;
+    out->rt_misses = task->rt.misses;
+    out->rt_overruns = task->rt.overruns;
+    out->syscalls = task->syscalls.calls;
+    out->syscall_max_us = task->syscalls.max_us;
+    out->syscall_us = task->syscalls.total_us;
 
-    printk("Switching to task %s\n", current->name);
+    // Include the slice the running task has not been charged for yet
+    if (task == current && task->state == RUNNING)
+        out->runtime_us += clock_us() - task->stats.stamp_us;
 
-    set_page_table(current->pt);
+    return 0;
+}
 
-    free_pending_l1_tables();
-}
\ No newline at end of file
+void sched_reset_syscall_stats(void)
+{
+    for (struct PCB *task = tasks; task; task = task->next)
+        memset(&task->syscalls, 0, sizeof(syscall_stat_t));
+
+    if (idle_task)
+        memset(&idle_task->syscalls, 0, sizeof(syscall_stat_t));
+}
+
+void sched_latency_info(sched_latency_info_t *out)
+{
+    out->uptime_us = clock_us();
+    out->samples = sched_latency_samples;
+    for (size_t i = 0; i < SCHED_LAT_BUCKETS; i++)
+        out->buckets[i] = sched_latency_hist[i];
+}
@@ -0,0 +1,169 @@
+#include <kernel/core/task/uaccess.h>
+
+// Returns the kernel address of the user page at va, faulting it in and breaking
+// copy-on-write if it is about to be written, or NULL if the task cannot access it
+static uint8_t *user_page(struct PCB *task, uintptr_t va, bool write)
+{
+    uint32_t entry = page_entry(task->pt, va);
+    if (!entry)
+    {
+        if (task_page_fault(task, va) < 0)
+            return NULL;
+        entry = page_entry(task->pt, va);
+    }
+
+    if (entry && write && L2_GET_AP(entry) != AP(AP_USER_RW))
+    {
+        if (task_cow_fault(task, va) < 0)
+            return NULL;
+        entry = page_entry(task->pt, va);
+    }
+
+    return entry ? (uint8_t *)COARSE_PAGE_BASE(entry) : NULL;
+}
+
+void user_walk_init(user_walk_t *walk, struct PCB *task, bool write)
+{
+    walk->task = task;
+    walk->page_va = 0;
+    walk->page = NULL;
+    walk->write = write;
+}
+
+void *user_walk(user_walk_t *walk, uintptr_t va)
+{
+    uintptr_t page_va = va & PAGE_MASK;
+    if (!walk->page || walk->page_va != page_va)
+    {
+        walk->page_va = page_va;
+        walk->page = user_page(walk->task, page_va, walk->write);
+        if (!walk->page)
+            return NULL;
+    }
+
+    return walk->page + (va & PAGE_OFFSET_MASK);
+}
+
+// Copies n bytes between buf and user memory at va of the current task, one page at a time
+static int8_t user_copy(user_walk_t *walk, uintptr_t va, uint8_t *buf, size_t n)
+{
+    while (n)
+    {
+        if (!user_walk(walk, va))
+            return -1;
+
+        size_t chunk = SMALL_PAGE_SIZE - (va & PAGE_OFFSET_MASK);
+        if (chunk > n)
+            chunk = n;
+
+        // The task's page table is active: go through its own mapping so no cache line is aliased
+        if (walk->write)
+            memcpy((void *)va, buf, chunk);
+        else
+            memcpy(buf, (void *)va, chunk);
+
+        va += chunk;
+        buf += chunk;
+        n -= chunk;
+    }
+
+    return 0;
+}
+
+// Makes every page of [p, p + n) present, and privately writable if write is set
+static int8_t user_prepare(const void *p, size_t n, bool write)
+{
+    if (!user_range_ok(p, n))
+        return -1;
+
+    uintptr_t end = (uintptr_t)p + n;
+    for (uintptr_t va = (uintptr_t)p & PAGE_MASK; va < end; va += SMALL_PAGE_SIZE)
+    {
+        if (!user_page(current, va, write))
+            return -1;
+    }
+
+    return 0;
+}
+
+bool user_range_ok(const void *p, size_t n)
+{
+    uintptr_t start = (uintptr_t)p;
+    uintptr_t end = start + n;
+
+    if (!current || current->kernel || n == 0)
+        return false;
+
+    return start >= USER_SPACE_START && end <= USER_SPACE_END && end >= start;
+}
+
+int8_t user_prepare_write(void *dst, size_t n)
+{
+    return user_prepare(dst, n, true);
+}
+
+int8_t user_prepare_read(const void *src, size_t n)
+{
+    return user_prepare(src, n, false);
+}
+
+int8_t copy_to_user(void *dst, const void *src, size_t n)
+{
+    if (!user_range_ok(dst, n))
+        return -1;
+
+    user_walk_t walk;
+    user_walk_init(&walk, current, true);
+    return user_copy(&walk, (uintptr_t)dst, (uint8_t *)src, n);
+}
+
+int8_t copy_from_user(void *dst, const void *src, size_t n)
+{
+    if (!user_range_ok(src, n))
+        return -1;
+
+    user_walk_t walk;
+    user_walk_init(&walk, current, false);
+    return user_copy(&walk, (uintptr_t)src, dst, n);
+}
+
+int32_t strnlen_user(const char *s, size_t max)
+{
+    user_walk_t walk;
+    user_walk_init(&walk, current, false);
+
+    for (size_t i = 0; i < max; i++)
+    {
+        if (!user_range_ok(s + i, 1))
+            return -1;
+
+        if (!user_walk(&walk, (uintptr_t)(s + i)))
+            return -1;
+
+        if (!s[i])
+            return i;
+    }
+
+    return max;
+}
+
+int32_t strncpy_from_user(char *dst, const char *src, size_t max)
+{
+    user_walk_t walk;
+    user_walk_init(&walk, current, false);
+
+    for (size_t i = 0; i < max; i++)
+    {
+        if (!user_range_ok(src + i, 1))
+            return -1;
+
+        if (!user_walk(&walk, (uintptr_t)(src + i)))
+            return -1;
+
+        dst[i] = src[i];
+        if (!dst[i])
+            return i;
+    }
+
+    return -1; // No terminator within max bytes
+}
@@ -0,0 +1,357 @@
+#include <kernel/core/task/vm_region.h>
+#include <kernel/core/task/elf/image_cache.h>
+
+static slab_cache_t *vm_region_cache = NULL;
+
+// Links a region into a list, which stays sorted by start address
+static void vm_region_link(vm_region_t **list, vm_region_t *region)
+{
+    vm_region_t **p = list;
+    while (*p && (*p)->start <= region->start)
+        p = &(*p)->next;
+
+    region->next = *p;
+    *p = region;
+}
+
+// Unlinks a region from a list without freeing it
+static void vm_region_unlink(vm_region_t **list, vm_region_t *region)
+{
+    vm_region_t **p = list;
+    while (*p && *p != region)
+        p = &(*p)->next;
+
+    if (*p)
+        *p = region->next;
+}
+
+// Drops the references of pt to the pages mapped in [start, end) and clears their entries
+static void vm_region_unmap(uint32_t *pt, uintptr_t start, uintptr_t end)
+{
+    uintptr_t va = start;
+    while (va < end)
+    {
+        uint32_t l1_entry = pt[L1_INDEX(va)];
+        if (is_user_section_entry(l1_entry))
+        {
+            // Sections only back blocks that lie entirely inside one region
+            for (size_t i = 0; i < NUM_COARSE_ENTRIES; i++)
+                page_put(ALLOC_4K, (void *)((l1_entry & SECTION_MASK) + i * SMALL_PAGE_SIZE));
+
+            pt[L1_INDEX(va)] = 0;
+            va = (va & SECTION_MASK) + SECTION_SIZE;
+            continue;
+        }
+
+        if (!is_valid_l1_coarse_entry(l1_entry))
+        {
+            va = (va & SECTION_MASK) + SECTION_SIZE; // Nothing mapped in this megabyte
+            continue;
+        }
+
+        uint32_t *coarse_pt = (uint32_t *)COARSE_BASE(l1_entry);
+        uint32_t entry = coarse_pt[L2_INDEX(va)];
+        if (is_valid_l2_coarse_entry(entry))
+        {
+            // Pages may be shared with other tasks after fork()
+            page_put(ALLOC_4K, (void *)l2_page_base(entry, va));
+            coarse_pt[L2_INDEX(va)] = 0;
+        }
+
+        va += SMALL_PAGE_SIZE;
+    }
+}
+
+vm_region_t *vm_region_insert(struct PCB *task, uintptr_t start, uintptr_t end, uint8_t ap, uint8_t type)
+{
+    if (!vm_region_cache)
+        vm_region_cache = create_slab_cache(sizeof(vm_region_t));
+
+    if (!vm_region_cache)
+        return NULL;
+
+    vm_region_t *region = slab_alloc(vm_region_cache);
+    if (!region)
+        return NULL;
+
+    memset(region, 0, sizeof(vm_region_t));
+    region->start = start & PAGE_MASK;
+    region->end = (end + PAGE_OFFSET_MASK) & PAGE_MASK;
+    region->ap = ap;
+    region->type = type;
+    region->fd = -1;
+
+    vm_region_link(&task->regions, region);
+
+    return region;
+}
+
+vm_region_t *vm_region_add(struct PCB *task, uintptr_t va, size_t memsz, uint8_t ap, int8_t fd, Elf32_Off offset, Elf32_Word filesz)
+{
+    vm_region_t *region = vm_region_insert(task, va, va + memsz, ap, VM_REGION_SEGMENT);
+    if (!region)
+        return NULL;
+
+    region->fd = fd;
+    region->offset = offset;
+    region->file_va = va;
+    region->filesz = filesz;
+
+    return region;
+}
+
+vm_region_t *vm_region_find(struct PCB *task, uintptr_t va)
+{
+    for (vm_region_t *region = task->regions; region && region->start <= va; region = region->next)
+    {
+        if (va < region->end)
+            return region;
+    }
+
+    return NULL;
+}
+
+void vm_region_remove(struct PCB *task, vm_region_t *region)
+{
+    vm_region_unmap(task->pt, region->start, region->end);
+    vm_region_unlink(&task->regions, region);
+    slab_free(vm_region_cache, region);
+}
+
+void vm_region_remove_all(struct PCB *task, uint8_t types)
+{
+    vm_region_t *region = task->regions;
+
+    while (region)
+    {
+        vm_region_t *next = region->next;
+        if (region->type & types)
+            vm_region_remove(task, region);
+        region = next;
+    }
+}
+
+// Copies the file-backed part of a region that falls inside the page at page_va
+static int8_t vm_region_read_page(vm_region_t *region, uintptr_t page_va, uint8_t *page)
+{
+    if (region->fd < 0)
+        return 0; // Anonymous memory stays zero-filled
+
+    uintptr_t file_start = region->file_va;
+    uintptr_t file_end = region->file_va + region->filesz;
+    uintptr_t from = page_va > file_start ? page_va : file_start;
+    uintptr_t to = (page_va + SMALL_PAGE_SIZE) < file_end ? (page_va + SMALL_PAGE_SIZE) : file_end;
+
+    if (from >= to)
+        return 0; // Page lies entirely in the zero-filled tail (.bss)
+
+    size_t len = to - from;
+    if (fat32_seek(region->fd, (int32_t)(region->offset + (from - file_start)), SEEK_SET) < 0)
+        return -1;
+
+    if (fat32_read(region->fd, page + (from - page_va), len) != (int32_t)len)
+        return -1;
+
+    // The segment may be code: the task fetches it from page_va, not through the kernel mapping
+    cache_sync_code((uintptr_t)page + (from - page_va), from, len);
+
+    return 0;
+}
+
+/*
+ * Maps the naturally aligned block of size bytes (a section or a large page)
+ * around va in one go. Returns 0 if it did, 1 if the block does not qualify or
+ * no contiguous memory is free (the caller maps a small page instead) and -2
+ * if the file could not be read.
+ */
+static int8_t vm_region_map_block(struct PCB *task, vm_region_t *region, uintptr_t va, size_t size)
+{
+    uintptr_t block = va & ~(size - 1);
+    if (block < region->start || block + size > region->end)
+        return 1;
+
+    // Every page must belong to this region alone so the whole block gets its permissions
+    for (vm_region_t *other = task->regions; other; other = other->next)
+    {
+        if (other != region && block < other->end && block + size > other->start)
+            return 1;
+    }
+
+    uint32_t *coarse_pt = NULL;
+    if (size == SECTION_SIZE)
+    {
+        if (task->pt[L1_INDEX(block)])
+            return 1; // Some pages of the block are mapped already
+    }
+    else
+    {
+        coarse_pt = get_coarse_table(task->pt, block, DOMAIN_USER);
+        if (!coarse_pt)
+            return 1;
+
+        for (size_t i = 0; i < LARGE_PAGE_ENTRIES; i++)
+        {
+            if (coarse_pt[L2_INDEX(block) + i])
+                return 1;
+        }
+    }
+
+    // Pages another instance already loaded are shared one by one instead
+    for (uintptr_t page_va = block; task->image && page_va < block + size; page_va += SMALL_PAGE_SIZE)
+    {
+        if (image_cache_page(task->image, page_va))
+            return 1;
+    }
+
+    size_t count = size / SMALL_PAGE_SIZE;
+    uint8_t *pages = alloc_pages(ALLOC_4K, count);
+    if (!pages)
+        return 1;
+
+    memset(pages, 0, size);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (vm_region_read_page(region, block + i * SMALL_PAGE_SIZE, pages + i * SMALL_PAGE_SIZE) < 0)
+        {
+            for (i = 0; i < count; i++)
+                free_page(ALLOC_4K, pages + i * SMALL_PAGE_SIZE);
+            return -2;
+        }
+    }
+
+    // The image cache keeps every 4KB page on its own, they are copied on write like small ones
+    uint8_t ap = region->ap;
+    for (size_t i = 0; task->image && i < count; i++)
+    {
+        if (image_cache_add_page(task->image, block + i * SMALL_PAGE_SIZE, (uintptr_t)(pages + i * SMALL_PAGE_SIZE)) == 0)
+            ap = AP_USER_READ;
+    }
+
+    if (size == SECTION_SIZE)
+    {
+        task->pt[L1_INDEX(block)] = SECTION_ENTRY((uintptr_t)pages, ap, DOMAIN_USER);
+        return 0;
+    }
+
+    for (size_t i = 0; i < LARGE_PAGE_ENTRIES; i++)
+        coarse_pt[L2_INDEX(block) + i] = L2_LARGE_ENTRY((uintptr_t)pages, AP(ap), C_WB, B_BUF);
+
+    return 0;
+}
+
+int8_t vm_region_fault(struct PCB *task, uintptr_t va)
+{
+    uintptr_t page_va = va & PAGE_MASK;
+
+    if (page_entry(task->pt, page_va))
+        return 0; // Already present
+
+    vm_region_t *region = vm_region_find(task, page_va);
+    if (!region || region->type != VM_REGION_SEGMENT)
+        return -1;
+
+    // Big segments are backed by sections or large pages while contiguous memory lasts
+    int8_t ret = vm_region_map_block(task, region, page_va, SECTION_SIZE);
+    if (ret == 1)
+        ret = vm_region_map_block(task, region, page_va, LARGE_PAGE_SIZE);
+    if (ret <= 0)
+        return ret;
+
+    uint32_t *coarse_pt = get_coarse_table(task->pt, page_va, DOMAIN_USER);
+    if (!coarse_pt)
+        return -3;
+
+    // Another instance of the same executable already loaded this page
+    uintptr_t cached = task->image ? image_cache_page(task->image, page_va) : 0;
+    if (cached)
+    {
+        // Cached pages are never written: writable ones are copied on the first write
+        page_get(ALLOC_4K, (void *)cached);
+        coarse_pt[L2_INDEX(page_va)] = L2_PAGE_ENTRY(cached, AP(AP_USER_READ), C_WB, B_BUF);
+        return 0;
+    }
+
+    uint8_t *page = alloc_page(ALLOC_4K);
+    if (!page)
+        return -3;
+
+    memset(page, 0, SMALL_PAGE_SIZE);
+
+    // The tail of one segment and the head of the next may share a page
+    uint8_t ap = AP_USER_READ;
+    for (vm_region_t *region = task->regions; region; region = region->next)
+    {
+        if (page_va + SMALL_PAGE_SIZE <= region->start || page_va >= region->end)
+            continue;
+
+        if (region->ap == AP_USER_RW)
+            ap = AP_USER_RW;
+
+        if (vm_region_read_page(region, page_va, page) < 0)
+        {
+            free_page(ALLOC_4K, page);
+            return -2;
+        }
+    }
+
+    // Keep the pristine page for later instances and map it copy-on-write
+    if (task->image && image_cache_add_page(task->image, page_va, (uintptr_t)page) == 0)
+        ap = AP_USER_READ;
+
+    coarse_pt[L2_INDEX(page_va)] = L2_PAGE_ENTRY((uintptr_t)page, AP(ap), C_WB, B_BUF);
+
+    return 0;
+}
+
+bool vm_region_writable(struct PCB *task, uintptr_t va)
+{
+    uintptr_t page_va = va & PAGE_MASK;
+
+    for (vm_region_t *region = task->regions; region; region = region->next)
+    {
+        if (page_va + SMALL_PAGE_SIZE <= region->start || page_va >= region->end)
+            continue;
+
+        if (region->ap == AP_USER_RW)
+            return true;
+    }
+
+    return false;
+}
+
+int8_t vm_region_copy_list(vm_region_t **dst, vm_region_t *src, uint8_t types)
+{
+    for (vm_region_t *region = src; region; region = region->next)
+    {
+        if (!(region->type & types))
+            continue;
+
+        vm_region_t *copy = slab_alloc(vm_region_cache);
+        if (!copy)
+            return -1;
+
+        memcpy(copy, region, sizeof(vm_region_t));
+        vm_region_link(dst, copy);
+    }
+
+    return 0;
+}
+
+int8_t vm_region_copy_all(struct PCB *dst, struct PCB *src)
+{
+    return vm_region_copy_list(&dst->regions, src->regions, VM_REGION_ALL);
+}
+
+void vm_region_free_list(vm_region_t **list)
+{
+    vm_region_t *region = *list;
+
+    while (region)
+    {
+        vm_region_t *next = region->next;
+        slab_free(vm_region_cache, region);
+        region = next;
+    }
+
+    *list = NULL;
+}
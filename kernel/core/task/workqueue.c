@@ -0,0 +1,75 @@
+#include <kernel/core/task/workqueue.h>
+#include <kernel/core/task/task.h>
+
+static work_t *work_head = NULL;
+static work_t *work_tail = NULL;
+static slab_cache_t *work_cache = NULL;
+static struct PCB *worker = NULL;
+
+static __attribute__((noreturn)) void worker_main(void)
+{
+    while (1)
+    {
+        unsigned int flags = irq_save();
+
+        work_t *work = work_head;
+        if (!work)
+        {
+            // Sleep until queue_work() makes the worker runnable again
+            worker->state = BLOCKED;
+            task_yield();
+            irq_restore(flags);
+            continue;
+        }
+
+        work_head = work->next;
+        if (!work_head)
+            work_tail = NULL;
+
+        work->fn(work->arg);
+        slab_free(work_cache, work);
+
+        irq_restore(flags); // Preemption point between items
+    }
+}
+
+void workqueue_init(void)
+{
+    if (!work_cache)
+        work_cache = create_slab_cache(sizeof(work_t));
+
+    worker = kthread_create(worker_main, "worker");
+    if (!worker)
+        printk("Failed to start the worker thread\n");
+}
+
+int8_t queue_work(work_fn_t fn, void *arg)
+{
+    unsigned int flags = irq_save();
+
+    if (!work_cache)
+        work_cache = create_slab_cache(sizeof(work_t));
+
+    work_t *work = work_cache ? slab_alloc(work_cache) : NULL;
+    if (!work)
+    {
+        irq_restore(flags);
+        return -1;
+    }
+
+    work->fn = fn;
+    work->arg = arg;
+    work->next = NULL;
+
+    if (work_tail)
+        work_tail->next = work;
+    else
+        work_head = work;
+    work_tail = work;
+
+    if (worker)
+        task_wake(worker);
+
+    irq_restore(flags);
+    return 0;
+}
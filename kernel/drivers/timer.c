@@ -1,4 +1,8 @@
 #include <kernel/drivers/timer.h>
+#include <kernel/arch/arm/interrupt.h>
+
+static uint32_t clock_last = 0; // Counter value at the last read
+static uint64_t clock_base = 0; // Microseconds elapsed up to clock_last
 
 void timer0_init(uint32_t load_value, uint8_t mode, uint8_t ie, uint8_t prescaler, uint8_t size, uint8_t oneshot)
 {
@@ -16,4 +20,33 @@ void timer2_init(uint32_t load_value, uint8_t mode, uint8_t ie, uint8_t prescale
 {
     timer2->load = load_value;                                // Load the timer with the initial value
     timer2->control = mode | ie | prescaler | size | oneshot; // Configure the timer
+}
+
+void clocksource_init(void)
+{
+    timer2_init(0xFFFFFFFF, TIMER_MODE_FREE_RUN, 0, TIMER_PRESCALE_NONE_gc, TIMER_SIZE_32, TIMER_WRAPPING);
+    clock_last = 0xFFFFFFFF;
+    clock_base = 0;
+    TIMER2_START();
+}
+
+uint64_t clock_us_count(uint32_t *count)
+{
+    unsigned int flags = irq_save();
+
+    uint32_t now = timer2->value;
+    clock_base += (uint32_t)(clock_last - now); // Counts down, wraps modulo 2^32
+    clock_last = now;
+
+    uint64_t us = clock_base;
+    irq_restore(flags);
+
+    if (count)
+        *count = now;
+    return us;
+}
+
+uint64_t clock_us(void)
+{
+    return clock_us_count(NULL);
 }
\ No newline at end of file
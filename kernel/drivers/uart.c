@@ -87,6 +87,12 @@ void uart_puts(pl011_t *dev, const char *s)
         uart_putc(dev, *s++);
 }
 
+void uart_write(pl011_t *dev, const char *buf, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        uart_putc(dev, buf[i]);
+}
+
 void uart_puthex(pl011_t *dev, uint32_t val)
 {
     char hex[9];
@@ -598,6 +598,25 @@ int8_t fat32_seek(int8_t fd, int32_t _offset, seek_op_t op)
     return 0;
 }
 
+int32_t fat32_tell(int8_t fd)
+{
+    fat32_file_t *file = get_file_by_fd(fd);
+    if (!file)
+        return -1;
+
+    return file->position;
+}
+
+int8_t fat32_fstat(int8_t fd, fat32_dir_entry_t *out)
+{
+    fat32_file_t *file = get_file_by_fd(fd);
+    if (!file)
+        return -1;
+
+    memcpy(out, &file->entry, sizeof(fat32_dir_entry_t));
+    return 0;
+}
+
 int32_t fat32_read(int8_t fd, void *buf, size_t size)
 {
     fat32_file_t *file = get_file_by_fd(fd);
@@ -620,24 +639,29 @@ int32_t fat32_read(int8_t fd, void *buf, size_t size)
     while (to_read > 0 && !fat32_is_eoc(cluster))
     {
         uint32_t lba = cluster_to_lba(cluster);
-        for (uint32_t s = 0; s < fat32_info.sectors_per_cluster && to_read > 0; ++s)
+        for (uint32_t s = cluster_offset / SECTOR_SIZE; s < fat32_info.sectors_per_cluster && to_read > 0; ++s)
         {
-            uint8_t sector[SECTOR_SIZE];
-            if (sd_read_block(lba + s, sector))
-                return -1;
-
-            uint32_t sector_offset = 0;
-            if (cluster_offset)
-            {
-                sector_offset = cluster_offset;
-                cluster_offset = 0;
-            }
+            uint32_t sector_offset = cluster_offset % SECTOR_SIZE;
+            cluster_offset = 0;
 
             uint32_t copy_len = SECTOR_SIZE - sector_offset;
             if (copy_len > to_read)
                 copy_len = to_read;
 
-            memcpy(buffer, sector + sector_offset, copy_len);
+            if (copy_len == SECTOR_SIZE && ((uintptr_t)buffer & 3) == 0)
+            {
+                // Whole sector into a word aligned buffer: let the driver fill it directly
+                if (sd_read_block(lba + s, buffer))
+                    return -1;
+            }
+            else
+            {
+                uint8_t sector[SECTOR_SIZE];
+                if (sd_read_block(lba + s, sector))
+                    return -1;
+
+                memcpy(buffer, sector + sector_offset, copy_len);
+            }
 
             buffer += copy_len;
             to_read -= copy_len;
@@ -907,6 +931,24 @@ int8_t fat32_close(int8_t fd)
     return 0;
 }
 
+int8_t fat32_dup(int8_t fd)
+{
+    fat32_file_t *file = get_file_by_fd(fd);
+    if (!file)
+        return -1;
+
+    for (int i = 0; i < MAX_OPEN_FILES; ++i)
+    {
+        if (!file_table[i].in_use)
+        {
+            memcpy(&file_table[i], file, sizeof(fat32_file_t));
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 static int8_t fat32_create_new(const char *path, fat32_dir_entry_t *new_entry)
 {
     // --- (1) Extract parent path ---
@@ -1029,10 +1071,10 @@ int32_t fat32_write(int8_t fd, uint8_t *buf, size_t size)
 
     uint32_t bytes_per_cluster = fat32_info.bytes_per_sector * fat32_info.sectors_per_cluster;
     uint32_t bytes_written = 0;
-    uint32_t curr_cluster = f->current_cluster;
+    uint32_t curr_cluster = ((uint32_t)f->entry.first_cluster_high << 16) | f->entry.first_cluster_low;
     uint32_t pos = f->position;
 
-    // Seek to correct cluster based on file position
+    // Seek to correct cluster based on file position, counting from the first one
     uint32_t cluster_offset = pos / bytes_per_cluster;
     for (uint32_t i = 0; i < cluster_offset; i++)
     {
@@ -0,0 +1,139 @@
+#include <kernel/fs/page_cache.h>
+
+static page_cache_entry_t *buckets[PAGE_CACHE_BUCKETS];
+static slab_cache_t *entry_cache = NULL;
+static size_t num_entries = 0;
+static size_t evict_hand = 0; // Bucket the next eviction scan starts at
+
+static inline size_t page_cache_hash(uint32_t cluster, uint32_t index)
+{
+    return (cluster * 31 + index) & (PAGE_CACHE_BUCKETS - 1);
+}
+
+// Only the cache references the page, and it holds nothing unwritten
+static inline bool page_cache_unused(page_cache_entry_t *entry)
+{
+    return !entry->dirty && page_ref_count(ALLOC_4K, (void *)entry->page) == 1;
+}
+
+static void page_cache_remove(page_cache_entry_t **p)
+{
+    page_cache_entry_t *entry = *p;
+    *p = entry->next;
+
+    page_put(ALLOC_4K, (void *)entry->page);
+    slab_free(entry_cache, entry);
+    num_entries--;
+}
+
+// Evicts one unused page, scanning the buckets round-robin
+static void page_cache_evict(void)
+{
+    for (size_t i = 0; i < PAGE_CACHE_BUCKETS; i++)
+    {
+        size_t bucket = (evict_hand + i) & (PAGE_CACHE_BUCKETS - 1);
+        for (page_cache_entry_t **p = &buckets[bucket]; *p; p = &(*p)->next)
+        {
+            if (page_cache_unused(*p))
+            {
+                page_cache_remove(p);
+                evict_hand = bucket + 1;
+                return;
+            }
+        }
+    }
+}
+
+page_cache_entry_t *page_cache_find(uint32_t cluster, uint32_t index)
+{
+    for (page_cache_entry_t *entry = buckets[page_cache_hash(cluster, index)]; entry; entry = entry->next)
+    {
+        if (entry->cluster == cluster && entry->index == index)
+            return entry;
+    }
+
+    return NULL;
+}
+
+page_cache_entry_t *page_cache_get(int8_t fd, uint32_t cluster, uint32_t index, uint32_t file_size)
+{
+    page_cache_entry_t *entry = page_cache_find(cluster, index);
+    if (entry)
+        return entry;
+
+    if (num_entries >= PAGE_CACHE_MAX)
+        page_cache_evict(); // If every page is in use the cache grows past the limit
+
+    if (!entry_cache)
+        entry_cache = create_slab_cache(sizeof(page_cache_entry_t));
+
+    entry = entry_cache ? slab_alloc(entry_cache) : NULL;
+    uint8_t *page = alloc_page(ALLOC_4K);
+    if (!entry || !page)
+        goto fail;
+
+    memset(page, 0, SMALL_PAGE_SIZE);
+
+    uint32_t offset = index * SMALL_PAGE_SIZE;
+    if (offset < file_size)
+    {
+        uint32_t len = file_size - offset < SMALL_PAGE_SIZE ? file_size - offset : SMALL_PAGE_SIZE;
+        if (fat32_seek(fd, offset, SEEK_SET) < 0 || fat32_read(fd, page, len) != (int32_t)len)
+            goto fail;
+
+        dcache_clean_range((uintptr_t)page, len); // Tasks read it through their own mapping
+    }
+
+    entry->cluster = cluster;
+    entry->index = index;
+    entry->page = (uintptr_t)page;
+    entry->dirty = false;
+    entry->writers = 0;
+
+    size_t bucket = page_cache_hash(cluster, index);
+    entry->next = buckets[bucket];
+    buckets[bucket] = entry;
+    num_entries++;
+
+    return entry;
+
+fail:
+    if (page)
+        free_page(ALLOC_4K, page);
+    if (entry)
+        slab_free(entry_cache, entry);
+    return NULL;
+}
+
+int8_t page_cache_writeback(page_cache_entry_t *entry, int8_t fd, uint32_t file_size)
+{
+    if (!entry->dirty)
+        return 0;
+
+    // Mappings never grow the file: the part of the page past its end is dropped
+    uint32_t offset = entry->index * SMALL_PAGE_SIZE;
+    if (offset < file_size)
+    {
+        uint32_t len = file_size - offset < SMALL_PAGE_SIZE ? file_size - offset : SMALL_PAGE_SIZE;
+        if (fat32_seek(fd, offset, SEEK_SET) < 0 || fat32_write(fd, (uint8_t *)entry->page, len) != (int32_t)len)
+            return -1;
+    }
+
+    entry->dirty = entry->writers > 0;
+    return 0;
+}
+
+void page_cache_invalidate(uint32_t cluster)
+{
+    for (size_t i = 0; i < PAGE_CACHE_BUCKETS; i++)
+    {
+        page_cache_entry_t **p = &buckets[i];
+        while (*p)
+        {
+            if ((*p)->cluster == cluster && page_cache_unused(*p))
+                page_cache_remove(p);
+            else
+                p = &(*p)->next;
+        }
+    }
+}
@@ -32,13 +32,24 @@ void init_page_allocator(uint8_t n, size_t num_pages, size_t page_size, uintptr_
     if (!alloc)
         return;
 
-    alloc->num_pages = num_pages;
+    // The bitmap and reference counts live in the first pages of the pool, so they grow with it
+    size_t num_words = (num_pages + 31) / 32;
+    size_t meta_size = num_words * sizeof(uint32_t) + num_pages * sizeof(uint16_t);
+    size_t meta_pages = (meta_size + page_size - 1) / page_size;
+
+    alloc->num_pages = meta_pages < num_pages ? num_pages : 0;
     alloc->page_size = page_size;
     alloc->base_addr = base_addr;
 
-    size_t num_words = (num_pages + 31) / 32;
-    alloc->bitmap = kmalloc(num_words * sizeof(uint32_t));
-    memset(alloc->bitmap, 0, num_words * sizeof(uint32_t));
+    if (!alloc->num_pages)
+    {
+        printk("Page allocator %u: pool of %u pages is too small\n", n, num_pages);
+        return;
+    }
+
+    alloc->bitmap = (uint32_t *)base_addr;
+    alloc->refs = (uint16_t *)(base_addr + num_words * sizeof(uint32_t));
+    memset((void *)base_addr, 0, meta_size);
 
     // Mask off unused bits in the last word
     size_t remaining_bits = num_pages % 32;
@@ -47,6 +58,13 @@ void init_page_allocator(uint8_t n, size_t num_pages, size_t page_size, uintptr_
         uint32_t mask = ~((1U << remaining_bits) - 1);
         alloc->bitmap[num_words - 1] |= mask;
     }
+
+    // The pages holding the metadata are never handed out
+    for (size_t page = 0; page < meta_pages; page++)
+    {
+        alloc->bitmap[page / 32] |= 1U << (page % 32);
+        alloc->refs[page] = 1;
+    }
 }
 
 void *alloc_page(uint8_t n)
@@ -57,9 +75,45 @@ void *alloc_page(uint8_t n)
     if (page < 0)
         return NULL;
 
-    void *addr = (void *)(alloc->base_addr + page * alloc->page_size);
-    printk("allocating page @ %p (size: %u)\n", addr, alloc->page_size);
-    return addr;
+    alloc->refs[page] = 1;
+
+    return (void *)(alloc->base_addr + page * alloc->page_size);
+}
+
+static inline bool page_is_free(PageAllocator *alloc, size_t page)
+{
+    return !(alloc->bitmap[page / 32] & (1U << (page % 32)));
+}
+
+void *alloc_pages(uint8_t n, size_t count)
+{
+    PageAllocator *alloc = get_page_allocator(n);
+    if (!alloc || count == 0)
+        return NULL;
+
+    // Candidate runs start on a physical address aligned to the size of the run
+    size_t align = count * alloc->page_size;
+    uintptr_t first = (alloc->base_addr + align - 1) & ~(align - 1);
+
+    for (size_t start = (first - alloc->base_addr) / alloc->page_size; start + count <= alloc->num_pages; start += count)
+    {
+        size_t i = 0;
+        while (i < count && page_is_free(alloc, start + i))
+            i++;
+
+        if (i < count)
+            continue;
+
+        for (i = 0; i < count; i++)
+        {
+            alloc->bitmap[(start + i) / 32] |= 1U << ((start + i) % 32);
+            alloc->refs[start + i] = 1;
+        }
+
+        return (void *)(alloc->base_addr + start * alloc->page_size);
+    }
+
+    return NULL;
 }
 
 void free_page(uint8_t n, void *addr)
@@ -79,5 +133,46 @@ void free_page(uint8_t n, void *addr)
     size_t bit = page % 32;
 
     alloc->bitmap[word] &= ~(1U << bit);
-    printk("freed page @ %p\n", addr);
+    alloc->refs[page] = 0;
+}
+
+// Returns the index of the page containing addr, or -1 if addr is not managed by alloc
+static inline int32_t page_index(PageAllocator *alloc, void *addr)
+{
+    uintptr_t a = (uintptr_t)addr;
+    if (!alloc || a < alloc->base_addr || a >= (alloc->base_addr + alloc->num_pages * alloc->page_size))
+        return -1;
+
+    return (a - alloc->base_addr) / alloc->page_size;
+}
+
+void page_get(uint8_t n, void *addr)
+{
+    PageAllocator *alloc = get_page_allocator(n);
+    int32_t page = page_index(alloc, addr);
+    if (page < 0)
+        return;
+
+    alloc->refs[page]++;
+}
+
+void page_put(uint8_t n, void *addr)
+{
+    PageAllocator *alloc = get_page_allocator(n);
+    int32_t page = page_index(alloc, addr);
+    if (page < 0 || alloc->refs[page] == 0)
+        return;
+
+    if (--alloc->refs[page] == 0)
+        free_page(n, (void *)(alloc->base_addr + page * alloc->page_size));
+}
+
+uint16_t page_ref_count(uint8_t n, void *addr)
+{
+    PageAllocator *alloc = get_page_allocator(n);
+    int32_t page = page_index(alloc, addr);
+    if (page < 0)
+        return 0;
+
+    return alloc->refs[page];
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include <user/lib/file.h>
+
+int32_t open(const char *path, uint32_t flags)
+{
+    return syscall(SYS_OPEN, (int32_t)path, (int32_t)flags, 0, 0);
+}
+
+int32_t read(int32_t fd, void *buf, size_t n)
+{
+    return syscall(SYS_READ, fd, (int32_t)buf, (int32_t)n, 0);
+}
+
+int32_t write(int32_t fd, const void *buf, size_t n)
+{
+    return syscall(SYS_WRITE, fd, (int32_t)buf, (int32_t)n, 0);
+}
+
+int32_t lseek(int32_t fd, int32_t offset, uint32_t whence)
+{
+    return syscall(SYS_LSEEK, fd, offset, (int32_t)whence, 0);
+}
+
+int32_t close(int32_t fd)
+{
+    return syscall(SYS_CLOSE, fd, 0, 0, 0);
+}
+
+int32_t stat(const char *path, stat_t *st)
+{
+    return syscall(SYS_STAT, (int32_t)path, (int32_t)st, 0, 0);
+}
+
+int32_t pipe_create(int32_t fds[2], uint32_t flags, uint32_t num_pages)
+{
+    return syscall(SYS_PIPE, (int32_t)fds, (int32_t)flags, (int32_t)num_pages, 0);
+}
+
+int32_t pipe(int32_t fds[2])
+{
+    return pipe_create(fds, 0, 0);
+}
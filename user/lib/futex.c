@@ -0,0 +1,35 @@
+#include <user/lib/futex.h>
+
+int32_t futex_wait(volatile uint32_t *uaddr, uint32_t expected)
+{
+    return syscall(SYS_FUTEX_WAIT, (int32_t)uaddr, (int32_t)expected, 0, 0);
+}
+
+int32_t futex_wake(volatile uint32_t *uaddr, uint32_t count)
+{
+    return syscall(SYS_FUTEX_WAKE, (int32_t)uaddr, (int32_t)count, 0, 0);
+}
+
+// Atomically stores value in *p and returns the old value (ARMv5 has no ldrex/strex)
+static inline uint32_t atomic_xchg(volatile uint32_t *p, uint32_t value)
+{
+    uint32_t old;
+    asm volatile("swp %0, %1, [%2]" : "=&r"(old) : "r"(value), "r"(p) : "memory");
+    return old;
+}
+
+void mutex_lock(mutex_t *m)
+{
+    if (atomic_xchg(&m->state, 1) == 0)
+        return; // Uncontended: no syscall
+
+    // Mark the lock contended so the owner wakes us when it unlocks
+    while (atomic_xchg(&m->state, 2) != 0)
+        futex_wait(&m->state, 2);
+}
+
+void mutex_unlock(mutex_t *m)
+{
+    if (atomic_xchg(&m->state, 0) == 2)
+        futex_wake(&m->state, 1);
+}
@@ -0,0 +1,21 @@
+#include <user/lib/ipc.h>
+
+int32_t port_create(void)
+{
+    return syscall(SYS_PORT_CREATE, 0, 0, 0, 0);
+}
+
+int32_t port_destroy(int32_t port)
+{
+    return syscall(SYS_PORT_DESTROY, port, 0, 0, 0);
+}
+
+int32_t port_send(int32_t port, const ipc_msg_t *msg, uint32_t flags)
+{
+    return syscall(SYS_PORT_SEND, port, (int32_t)msg, (int32_t)flags, 0);
+}
+
+int32_t port_receive(int32_t port, ipc_msg_t *msg, uint32_t flags)
+{
+    return syscall(SYS_PORT_RECV, port, (int32_t)msg, (int32_t)flags, 0);
+}
@@ -0,0 +1,79 @@
+#include <user/lib/kdata.h>
+
+#define KDATA ((const volatile kdata_t *)KDATA_BASE)
+#define CLOCK_COUNTER (*(const volatile uint32_t *)(KDATA_TIMER_BASE + KDATA_TIMER_VALUE))
+
+// Waits out an update in progress and returns the sequence number to check against
+static inline uint32_t kdata_read_begin(void)
+{
+    uint32_t seq;
+    while ((seq = KDATA->seq) & 1)
+        ;
+
+    asm volatile("" : : : "memory");
+    return seq;
+}
+
+// Whether the kernel updated the page since kdata_read_begin() returned seq
+static inline int kdata_read_retry(uint32_t seq)
+{
+    asm volatile("" : : : "memory");
+    return KDATA->seq != seq;
+}
+
+void kdata_read(kdata_t *out)
+{
+    uint32_t seq;
+    do
+    {
+        seq = kdata_read_begin();
+        out->clock_last = KDATA->clock_last;
+        out->clock_base_us = KDATA->clock_base_us;
+        out->ticks = KDATA->ticks;
+        out->switches = KDATA->switches;
+        out->pid = KDATA->pid;
+        out->tgid = KDATA->tgid;
+        out->nr_tasks = KDATA->nr_tasks;
+    } while (kdata_read_retry(seq));
+
+    out->seq = seq;
+}
+
+uint64_t clock_us(void)
+{
+    uint32_t seq, last, now;
+    uint64_t base;
+    do
+    {
+        seq = kdata_read_begin();
+        base = KDATA->clock_base_us;
+        last = KDATA->clock_last;
+        now = CLOCK_COUNTER;
+    } while (kdata_read_retry(seq));
+
+    return base + (uint32_t)(last - now); // The counter counts down and wraps
+}
+
+// The page always describes the running thread, which is the caller
+uint32_t getpid(void)
+{
+    return KDATA->tgid;
+}
+
+uint32_t gettid(void)
+{
+    return KDATA->pid;
+}
+
+uint64_t sched_ticks(void)
+{
+    uint32_t seq;
+    uint64_t ticks;
+    do
+    {
+        seq = kdata_read_begin();
+        ticks = KDATA->ticks;
+    } while (kdata_read_retry(seq));
+
+    return ticks;
+}
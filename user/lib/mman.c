@@ -0,0 +1,17 @@
+#include <user/lib/mman.h>
+
+void *mmap(size_t length, uint32_t prot, int32_t fd, uint32_t offset)
+{
+    int32_t va = syscall(SYS_MMAP, fd, (int32_t)offset, (int32_t)length, (int32_t)prot);
+    return va == -1 ? MAP_FAILED : (void *)va;
+}
+
+int32_t munmap(void *addr)
+{
+    return syscall(SYS_MUNMAP, (int32_t)addr, 0, 0, 0);
+}
+
+int32_t msync(void *addr, size_t length)
+{
+    return syscall(SYS_MSYNC, (int32_t)addr, (int32_t)length, 0, 0);
+}
@@ -1,24 +1,89 @@
 #include <user/lib/printf.h>
 
+static char stdout_buf[STDOUT_BUF_SIZE];
+static size_t stdout_len = 0;
+static int stdout_mode = STDOUT_LINE;
+static mutex_t stdout_lock = MUTEX_INIT; // Threads of a task share the buffer
+
+// Called with stdout_lock held
+static int stdout_flush_locked(void)
+{
+    size_t done = 0;
+    while (done < stdout_len)
+    {
+        int32_t n = write(STDOUT_FILENO, stdout_buf + done, stdout_len - done);
+        if (n <= 0)
+        {
+            stdout_len = 0; // Drop what cannot be written rather than retry forever
+            return -1;
+        }
+        done += n;
+    }
+
+    stdout_len = 0;
+    return 0;
+}
+
+int stdout_flush(void)
+{
+    mutex_lock(&stdout_lock);
+    int res = stdout_flush_locked();
+    mutex_unlock(&stdout_lock);
+
+    return res;
+}
+
+int stdout_set_buffering(int mode)
+{
+    if (mode != STDOUT_UNBUFFERED && mode != STDOUT_LINE && mode != STDOUT_FULL)
+        return -1;
+
+    mutex_lock(&stdout_lock);
+    stdout_flush_locked();
+    stdout_mode = mode;
+    mutex_unlock(&stdout_lock);
+
+    return 0;
+}
+
+// Append n bytes to stdout, flushing as the buffering mode requires. Called with stdout_lock held
+static int stdout_put(const char *s, size_t n)
+{
+    bool newline = false;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if (stdout_len == STDOUT_BUF_SIZE && stdout_flush_locked() < 0)
+            return -1;
+
+        stdout_buf[stdout_len++] = s[i];
+        newline |= s[i] == '\n';
+    }
+
+    if (stdout_mode == STDOUT_UNBUFFERED || (stdout_mode == STDOUT_LINE && newline))
+        return stdout_flush_locked();
+
+    return 0;
+}
+
 int printf(const char *fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
 
     char formatted[1024]; // No malloc yet
-    vsnprintf(formatted, 1024, fmt, args);
-    va_end(args);
-
-    if (!formatted)
+    if (vsnprintf(formatted, 1024, fmt, args) < 0)
     {
+        va_end(args);
         return -1;
     }
+    va_end(args);
 
-    syscall(SYS_PRINTF, (int32_t)formatted, 0, 0, 0);
-
-    // Calculate length for return value
     int len = strlen(formatted);
-    // free(formatted);
 
-    return len;
-}
\ No newline at end of file
+    mutex_lock(&stdout_lock);
+    int res = stdout_put(formatted, len);
+    mutex_unlock(&stdout_lock);
+
+    return res < 0 ? -1 : len;
+}
@@ -0,0 +1,39 @@
+#include <user/lib/ring.h>
+
+ring_t *ring_setup(void)
+{
+    int32_t va = syscall(SYS_RING_SETUP, 0, 0, 0, 0);
+    return va == -1 ? NULL : (ring_t *)va;
+}
+
+int32_t ring_submit(ring_t *ring, const ring_sqe_t *sqe)
+{
+    if (ring->sq_tail - ring->sq_head >= RING_SQ_ENTRIES)
+        return -1;
+
+    ring->sqes[ring->sq_tail & (RING_SQ_ENTRIES - 1)] = *sqe;
+
+    // The entry must be complete before the kernel can see it
+    asm volatile("" : : : "memory");
+    ring->sq_tail++;
+
+    return 0;
+}
+
+int32_t ring_enter(uint32_t flags)
+{
+    return syscall(SYS_ENTER, (int32_t)flags, 0, 0, 0);
+}
+
+ring_cqe_t *ring_peek_cqe(ring_t *ring)
+{
+    if (ring->cq_head == ring->cq_tail)
+        return NULL;
+
+    return &ring->cqes[ring->cq_head & (RING_CQ_ENTRIES - 1)];
+}
+
+void ring_cqe_seen(ring_t *ring)
+{
+    ring->cq_head++;
+}
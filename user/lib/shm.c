@@ -0,0 +1,12 @@
+#include <user/lib/shm.h>
+
+void *shm_attach(const char *name, size_t size)
+{
+    int32_t va = syscall(SYS_SHM_ATTACH, (int32_t)name, (int32_t)size, 0, 0);
+    return va == -1 ? NULL : (void *)va;
+}
+
+int32_t shm_detach(void *addr)
+{
+    return syscall(SYS_SHM_DETACH, (int32_t)addr, 0, 0, 0);
+}
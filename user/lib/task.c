@@ -2,7 +2,65 @@
 
 __attribute__((noreturn)) void exit(void)
 {
-    syscall(SYS_EXIT, 0, 0, 0, 0); // Exit status = 0
+    _exit(0);
+}
+
+__attribute__((noreturn)) void _exit(int32_t status)
+{
+    stdout_flush();
+    syscall(SYS_EXIT, status, 0, 0, 0);
     while (1)
         ;
-}
\ No newline at end of file
+}
+
+void yield(void)
+{
+    syscall(SYS_YIELD, 0, 0, 0, 0);
+}
+
+int32_t wait(int32_t *status)
+{
+    return syscall(SYS_WAIT, (int32_t)status, 0, 0, 0);
+}
+
+int32_t fork(void)
+{
+    stdout_flush(); // Otherwise both tasks would print what is buffered
+    return syscall(SYS_FORK, 0, 0, 0, 0);
+}
+
+// First code run by a new thread: the kernel passes fn and arg in r0 and r1
+static __attribute__((noreturn)) void thread_start(int32_t (*fn)(void *), void *arg)
+{
+    _exit(fn(arg));
+}
+
+int32_t thread_create(int32_t (*fn)(void *), void *arg)
+{
+    return syscall(SYS_CLONE, (int32_t)thread_start, (int32_t)fn, (int32_t)arg, 0);
+}
+
+int32_t sched_set_rt(uint32_t period_us, uint32_t runtime_us, uint32_t deadline_us)
+{
+    return syscall(SYS_SCHED_SETRT, (int32_t)period_us, (int32_t)runtime_us, (int32_t)deadline_us, 0);
+}
+
+int32_t sched_task_info(uint32_t index, sched_task_info_t *out)
+{
+    return syscall(SYS_SCHED_INFO, SCHED_INFO_TASK, (int32_t)index, (int32_t)out, 0);
+}
+
+int32_t sched_latency_info(sched_latency_info_t *out)
+{
+    return syscall(SYS_SCHED_INFO, SCHED_INFO_LATENCY, 0, (int32_t)out, 0);
+}
+
+int32_t syscall_stats(syscall_stats_t *out)
+{
+    return syscall(SYS_SYSCALL_STATS, SYSCALL_STATS_GET, (int32_t)out, 0, 0);
+}
+
+int32_t syscall_stats_reset(void)
+{
+    return syscall(SYS_SYSCALL_STATS, SYSCALL_STATS_RESET, 0, 0, 0);
+}